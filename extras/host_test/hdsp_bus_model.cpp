@@ -0,0 +1,230 @@
+/***************************************************
+  Host model of an MCP23017 driving two HDSP2111s.
+  See hdsp_bus_model.h
+ ****************************************************/
+#include "hdsp_bus_model.h"
+
+HardwareSerial Serial;
+
+namespace bus_model {
+
+hdsp_chip_model    CHIPS[2];
+unsigned long long NOW_NS = 0;
+unsigned long long DELAY_NS = 0;
+unsigned long      CALLS = 0;
+unsigned long      BYTES = 0;
+unsigned long      VIOLATIONS = 0;
+const char        *LAST_VIOLATION = "";
+
+//port A:  A0:A3 = bits 0:3, #RD = 4, #WR = 5, #CE1 = 6, #CE2 = 7
+static const uint8_t RD_BIT = (1 << HDSP_RD);
+static const uint8_t WR_BIT = (1 << HDSP_WR);
+static const uint8_t CE_BITS[2] = { (1 << HDSP_CE1), (1 << HDSP_CE2) };
+
+static uint32_t                BUS_STEP_NS = 0;
+static hdsp2111_timing_profile LIMITS;
+static uint8_t                 PORT_A = 0xFF;
+static uint8_t                 PORT_B = 0x00;
+static unsigned long long      ADDRESS_DATA_CHANGED = 0;
+static unsigned long long      STROBE_RELEASED = 0;
+static bool                    RELEASED_ONCE = false;
+static unsigned long long      WRITE_START[2];
+static unsigned long long      READ_START[2];
+
+
+static void violation(const char *what) {
+    VIOLATIONS++;
+    LAST_VIOLATION = what;
+}
+
+void reset(uint32_t busstepns, const hdsp2111_timing_profile &limits) {
+    memset(CHIPS, 0, sizeof(CHIPS));
+    NOW_NS = 0;
+    DELAY_NS = 0;
+    CALLS = 0;
+    BYTES = 0;
+    VIOLATIONS = 0;
+    LAST_VIOLATION = "";
+    BUS_STEP_NS = busstepns;
+    LIMITS = limits;
+    PORT_A = 0xFF;
+    PORT_B = 0x00;
+    ADDRESS_DATA_CHANGED = 0;
+    STROBE_RELEASED = 0;
+    RELEASED_ONCE = false;
+}
+
+void advanceMs(unsigned long ms) {
+    NOW_NS += (unsigned long long) ms * 1000000ULL;
+}
+
+unsigned long clockMs(void) {
+    return (unsigned long) (NOW_NS / 1000000ULL);
+}
+
+
+static bool writing(uint8_t porta, uint8_t chip) {
+    return !(porta & CE_BITS[chip]) && !(porta & WR_BIT);
+}
+
+static bool reading(uint8_t porta, uint8_t chip) {
+    return !(porta & CE_BITS[chip]) && !(porta & RD_BIT);
+}
+
+//address (A0:A3) or data moved -- never allowed mid-strobe, and
+//only HOLD_NS after the last strobe let go
+static void addressDataChanged(void) {
+    for (uint8_t c = 0; c < 2; c++) {
+        if (writing(PORT_A, c) || reading(PORT_A, c)) {
+            violation("address/data changed during strobe");
+        }
+    }
+    if (RELEASED_ONCE && (NOW_NS - STROBE_RELEASED < LIMITS.HOLD_NS)) {
+        violation("address/data hold");
+    }
+    ADDRESS_DATA_CHANGED = NOW_NS;
+}
+
+static void latch(uint8_t chip, uint8_t porta) {
+    if (porta & 0x08) {
+        CHIPS[chip].RAM[porta & 0x07] = (char) PORT_B;
+    } else {
+        CHIPS[chip].CONTROL = PORT_B;
+    }
+    CHIPS[chip].WRITES++;
+}
+
+static void setPortA(uint8_t value) {
+    uint8_t old = PORT_A;
+    if ( (old ^ value) & 0x0F ) {
+        addressDataChanged();
+    }
+    PORT_A = value;
+    
+    if ( !(value & RD_BIT) && !(value & WR_BIT) ) {
+        violation("#RD and #WR low together");
+    }
+    
+    for (uint8_t c = 0; c < 2; c++) {
+        bool oldcelow = !(old & CE_BITS[c]);
+        
+        if (!writing(old, c) && writing(value, c)) {
+            //CE has to be down first, #WR is the strobe
+            if (!oldcelow) {
+                violation("#WR fell before #CE");
+            }
+            if (NOW_NS - ADDRESS_DATA_CHANGED < LIMITS.ADDRESS_SETUP_NS) {
+                violation("address/data setup");
+            }
+            WRITE_START[c] = NOW_NS;
+        } else if (writing(old, c) && !writing(value, c)) {
+            if (NOW_NS - WRITE_START[c] < LIMITS.WRITE_PULSE_NS) {
+                violation("write pulse width");
+            }
+            latch(c, old);
+            STROBE_RELEASED = NOW_NS;
+            RELEASED_ONCE = true;
+        }
+        
+        if (!reading(old, c) && reading(value, c)) {
+            if (!oldcelow) {
+                violation("#RD fell before #CE");
+            }
+            READ_START[c] = NOW_NS;
+        } else if (reading(old, c) && !reading(value, c)) {
+            STROBE_RELEASED = NOW_NS;
+            RELEASED_ONCE = true;
+        }
+    }
+}
+
+static void busCall(unsigned long bytes) {
+    NOW_NS += BUS_STEP_NS;
+    CALLS++;
+    BYTES += bytes;
+}
+
+}   // namespace bus_model
+
+
+using namespace bus_model;
+
+// ------------ Arduino stand-ins ------------------------------
+unsigned long millis(void) {
+    return clockMs();
+}
+
+void delay(unsigned long ms) {
+    NOW_NS += (unsigned long long) ms * 1000000ULL;
+    DELAY_NS += (unsigned long long) ms * 1000000ULL;
+}
+
+void delayMicroseconds(unsigned int us) {
+    NOW_NS += (unsigned long long) us * 1000ULL;
+    DELAY_NS += (unsigned long long) us * 1000ULL;
+}
+
+
+// ------------ MCP23017 stand-in ------------------------------
+// Byte counts are I2C bytes excluding start/stop: a register write
+// is addr+reg+data, a read is addr+reg then addr+data, and
+// writePin is a read-modify-write of the GPIO register.
+void Adafruit_MCP23017::begin(uint8_t addr) {
+    (void) addr;
+}
+
+void Adafruit_MCP23017::setGPIOABMode(uint16_t mode) {
+    (void) mode;
+    busCall(4);
+}
+
+void Adafruit_MCP23017::setGPIOBMode(uint8_t mode) {
+    (void) mode;
+    busCall(3);
+}
+
+void Adafruit_MCP23017::writePin(uint8_t pin, uint8_t value) {
+    busCall(7);
+    if (pin < 8) {
+        setPortA(value ? (PORT_A | (1 << pin)) : (PORT_A & ~(1 << pin)));
+    } else {
+        uint8_t b = value ? (PORT_B | (1 << (pin-8))) : (PORT_B & ~(1 << (pin-8)));
+        if (b != PORT_B) {
+            addressDataChanged();
+            PORT_B = b;
+        }
+    }
+}
+
+void Adafruit_MCP23017::writeGPIOA(uint8_t value) {
+    busCall(3);
+    setPortA(value);
+}
+
+void Adafruit_MCP23017::writeGPIOB(uint8_t value) {
+    busCall(3);
+    if (value != PORT_B) {
+        addressDataChanged();
+        PORT_B = value;
+    }
+}
+
+uint8_t Adafruit_MCP23017::readGPIOB(void) {
+    busCall(4);
+    int8_t driver = -1;
+    for (uint8_t c = 0; c < 2; c++) {
+        if (reading(PORT_A, c)) {
+            if (driver >= 0) {
+                violation("two chips driving the data bus");
+            }
+            driver = c;
+        }
+    }
+    if (driver < 0) {
+        return PORT_B;
+    }
+    if (NOW_NS - READ_START[driver] < LIMITS.READ_ACCESS_NS) {
+        violation("read access time");
+    }
+    return CHIPS[driver].CONTROL;
+}
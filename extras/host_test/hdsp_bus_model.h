@@ -0,0 +1,40 @@
+/***************************************************
+  Host model of an MCP23017 driving two HDSP2111s
+  on a shared data/address bus.
+
+  Each MCP23017 call costs BUS_STEP_NS of simulated
+  time, delay()/delayMicroseconds() add their own.
+  The chips latch writes and answer control word
+  reads like the real thing, and every strobe is
+  checked against a set of minimum timings.
+ ****************************************************/
+#ifndef _HDSP_BUS_MODEL_H_
+#define _HDSP_BUS_MODEL_H_
+
+#include "mizraith_HDSP2111.h"
+
+struct hdsp_chip_model {
+    char          RAM[8];          //character RAM, A3=1
+    uint8_t       CONTROL;         //control word, A3=0
+    unsigned long WRITES;          //strobes latched by this chip
+};
+
+namespace bus_model {
+    //start over with busstepns per MCP23017 call, checking against limits
+    void reset(uint32_t busstepns, const hdsp2111_timing_profile &limits);
+    
+    //let simulated time pass (no bus activity)
+    void advanceMs(unsigned long ms);
+    //simulated time in ms, usable as an HDSP2111ClockSource
+    unsigned long clockMs(void);
+    
+    extern hdsp_chip_model    CHIPS[2];
+    extern unsigned long long NOW_NS;
+    extern unsigned long long DELAY_NS;      //spent in delay()/delayMicroseconds()
+    extern unsigned long      CALLS;         //MCP23017 calls
+    extern unsigned long      BYTES;         //I2C bytes those calls put on the wire
+    extern unsigned long      VIOLATIONS;    //timing or ordering problems seen
+    extern const char        *LAST_VIOLATION;
+}
+
+#endif
@@ -0,0 +1,39 @@
+/***************************************************
+  Tiny check macros shared by the host tests.
+ ****************************************************/
+#ifndef _HOST_TEST_H_
+#define _HOST_TEST_H_
+
+#include <stdio.h>
+#include "hdsp_bus_model.h"
+
+static int host_test_failures = 0;
+
+#define CHECK(cond)  do { \
+        if (!(cond)) { \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_FRAME(chip, text)  CHECK(memcmp(bus_model::CHIPS[chip].RAM, (text), 8) == 0)
+
+//Fresh bus model and a library instance on it: virtual clock, the
+//given strobe timing, chips set up and blanked.  Bus step 0 means the
+//transport adds no time of its own, limits are what the chips check.
+static inline void startOnBus(mizraith_HDSP2111 &hdsp,
+                              const hdsp2111_timing_profile *profile = &HDSP_TIMING_DATASHEET,
+                              uint32_t busstepns = 0,
+                              const hdsp2111_timing_profile &limits = HDSP_TIMING_DATASHEET) {
+    bus_model::reset(busstepns, limits);
+    hdsp.setClockSource(bus_model::clockMs);
+    hdsp.setTimingProfile(profile);
+    hdsp.setup(0);
+    hdsp.resetDisplays();
+}
+
+#define HOST_TEST_RESULT(name)  ( \
+        printf("%s %s\n", host_test_failures ? "FAIL" : "PASS", (name)), \
+        host_test_failures ? 1 : 0 )
+
+#endif
@@ -0,0 +1,22 @@
+/***************************************************
+  Host stand-in for the MCP23017 port expander.  All 
+  instances drive the same simulated bus, see
+  hdsp_bus_model.cpp.
+ ****************************************************/
+#ifndef _HOST_ADAFRUIT_MCP23017_H_
+#define _HOST_ADAFRUIT_MCP23017_H_
+
+#include "Arduino.h"
+
+class Adafruit_MCP23017 {
+  public:
+    void begin(uint8_t addr);
+    void setGPIOABMode(uint16_t mode);
+    void setGPIOBMode(uint8_t mode);
+    void writePin(uint8_t pin, uint8_t value);
+    void writeGPIOA(uint8_t value);
+    void writeGPIOB(uint8_t value);
+    uint8_t readGPIOB(void);
+};
+
+#endif
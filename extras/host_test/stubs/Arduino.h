@@ -0,0 +1,37 @@
+/***************************************************
+  Host stand-in for Arduino.h -- just enough for
+  mizraith_HDSP2111 to build and run on a PC.
+  Time comes from the bus model (hdsp_bus_model.cpp).
+ ****************************************************/
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define HIGH  1
+#define LOW   0
+#define DEC   10
+#define BIN   2
+
+#define F(s)  (s)
+
+typedef bool boolean;
+
+unsigned long millis(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+//Output is thrown away, the tests check state instead
+class HardwareSerial {
+  public:
+    template <typename T> void print(T) {}
+    template <typename T> void print(T, int) {}
+    template <typename T> void println(T) {}
+    template <typename T> void println(T, int) {}
+    void println(void) {}
+};
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,4 @@
+// Host stand-in for <avr/pgmspace.h>, nothing is needed from it.
+#ifndef _HOST_PGMSPACE_H_
+#define _HOST_PGMSPACE_H_
+#endif
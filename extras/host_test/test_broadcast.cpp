@@ -0,0 +1,142 @@
+/***************************************************
+  Shared bus broadcast: both chips latch the same
+  frames and control words when their data matches,
+  for fewer bus calls than one display at a time.
+  Display 0 is rejected without touching the bus.
+ ****************************************************/
+#include "host_test.h"
+
+static const uint16_t STEPS = 200;
+
+struct bus_count {
+    unsigned long CALLS;
+    unsigned long BYTES;
+};
+
+static void mark(bus_count &count) {
+    count.CALLS = bus_model::CALLS;
+    count.BYTES = bus_model::BYTES;
+}
+
+static void since(bus_count &count) {
+    count.CALLS = bus_model::CALLS - count.CALLS;
+    count.BYTES = bus_model::BYTES - count.BYTES;
+}
+
+//scroll text1 on display 1 and text2 on display 2 in lock step
+static void scroll(const char *text1, const char *text2, bus_count &count, bool mirrored) {
+    static char copy1[64];
+    static char copy2[64];
+    strncpy(copy1, text1, sizeof(copy1) - 1);
+    strncpy(copy2, text2, sizeof(copy2) - 1);
+
+    mizraith_HDSP2111 hdsp;
+    startOnBus(hdsp);
+    hdsp.setDisplayStringAsNew(copy1, 1);
+    hdsp.setDisplayStringAsNew(copy2, 2);
+
+    mark(count);
+    for (uint16_t step = 0; step < STEPS; step++) {
+        bus_model::advanceMs(200);
+        hdsp.updateDisplays();
+        hdsp.automaticallyResetScrollFlagAndPositions();
+        if (mirrored) {
+            CHECK(memcmp(bus_model::CHIPS[0].RAM, bus_model::CHIPS[1].RAM, 8) == 0);
+            CHECK(bus_model::CHIPS[0].WRITES == bus_model::CHIPS[1].WRITES);
+        }
+    }
+    since(count);
+    CHECK(bus_model::VIOLATIONS == 0);
+}
+
+
+int main(void) {
+    //one static frame, broadcast vs a display at a time
+    {
+        mizraith_HDSP2111 hdsp;
+        bus_count each, both;
+
+        startOnBus(hdsp);
+        mark(each);
+        hdsp.writeDisplay((char *) "SAMEWORD", 1);
+        hdsp.writeDisplay((char *) "SAMEWORD", 2);
+        since(each);
+        CHECK_FRAME(0, "SAMEWORD");
+        CHECK_FRAME(1, "SAMEWORD");
+
+        startOnBus(hdsp);
+        mark(both);
+        hdsp.writeDisplays((char *) "SAMEWORD", HDSP_ALL_DISPLAYS);
+        since(both);
+        CHECK_FRAME(0, "SAMEWORD");
+        CHECK_FRAME(1, "SAMEWORD");
+        CHECK(bus_model::CHIPS[0].WRITES == bus_model::CHIPS[1].WRITES);
+        CHECK(both.CALLS < each.CALLS);
+        CHECK(bus_model::VIOLATIONS == 0);
+        printf("  static     calls each %lu broadcast %lu   bytes each %lu broadcast %lu\n",
+               each.CALLS, both.CALLS, each.BYTES, both.BYTES);
+    }
+
+    //mirrored scrolling is grouped, different text is not
+    {
+        bus_count apart, mirrored;
+        scroll("The quick brown fox jumps over the lazy dog",
+               "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG", apart, false);
+        scroll("The quick brown fox jumps over the lazy dog",
+               "The quick brown fox jumps over the lazy dog", mirrored, true);
+        CHECK(mirrored.CALLS < apart.CALLS);
+        CHECK(mirrored.BYTES < apart.BYTES);
+        printf("  scroll     calls/step apart %.1f mirrored %.1f   bytes/step apart %.1f mirrored %.1f\n",
+               (double) apart.CALLS / STEPS, (double) mirrored.CALLS / STEPS,
+               (double) apart.BYTES / STEPS, (double) mirrored.BYTES / STEPS);
+    }
+
+    //control words land on both chips
+    {
+        mizraith_HDSP2111 hdsp;
+        startOnBus(hdsp);
+        bus_model::CHIPS[0].CONTROL = 0x55;
+        bus_model::CHIPS[1].CONTROL = 0x2A;
+        hdsp.resetDisplays();
+        CHECK(bus_model::CHIPS[0].CONTROL == 0x00);
+        CHECK(bus_model::CHIPS[1].CONTROL == 0x00);
+
+        hdsp.setBrightnessForAllDisplays(3);
+        CHECK((bus_model::CHIPS[0].CONTROL & 0x07) == 3);
+        CHECK(bus_model::CHIPS[0].CONTROL == bus_model::CHIPS[1].CONTROL);
+
+        //only one control word differs, the rest still match
+        hdsp.setBrightnessForDisplay(5, 2);
+        CHECK((bus_model::CHIPS[0].CONTROL & 0x07) == 3);
+        CHECK((bus_model::CHIPS[1].CONTROL & 0x07) == 5);
+        hdsp.setBrightnessForAllDisplays(1);
+        CHECK((bus_model::CHIPS[0].CONTROL & 0x07) == 1);
+        CHECK(bus_model::CHIPS[0].CONTROL == bus_model::CHIPS[1].CONTROL);
+        CHECK(bus_model::VIOLATIONS == 0);
+    }
+
+    //display 0 is not a display, and must not reach the bus
+    {
+        mizraith_HDSP2111 hdsp;
+        startOnBus(hdsp);
+        hdsp.writeDisplays((char *) "ORIGINAL", HDSP_ALL_DISPLAYS);
+        uint8_t control0 = bus_model::CHIPS[0].CONTROL;
+        uint8_t control1 = bus_model::CHIPS[1].CONTROL;
+        unsigned long calls = bus_model::CALLS;
+
+        hdsp.writeDisplay((char *) "NOTSHOWN", 0);
+        hdsp.setBrightnessForDisplay(4, 0);
+        hdsp.resetDisplay(0);
+        hdsp.updateDisplayScroll(0);
+        CHECK(bus_model::CALLS == calls);
+        CHECK_FRAME(0, "ORIGINAL");
+        CHECK_FRAME(1, "ORIGINAL");
+        CHECK(bus_model::CHIPS[0].CONTROL == control0);
+        CHECK(bus_model::CHIPS[1].CONTROL == control1);
+        CHECK(HDSP_DISPLAY_MASK(0) == 0);
+        CHECK(HDSP_DISPLAY_MASK(1) == 0x01);
+        CHECK(HDSP_DISPLAY_MASK(2) == 0x02);
+    }
+
+    return HOST_TEST_RESULT("test_broadcast");
+}
@@ -0,0 +1,133 @@
+/***************************************************
+  Message queue: priorities, repeats, dwell and the
+  completion callback, on the bus model.
+ ****************************************************/
+#include "host_test.h"
+
+static char         done[8][24];
+static uint8_t      donecount = 0;
+
+static void messageDone(uint8_t displaynum, char *text) {
+    (void) displaynum;
+    if (donecount < 8) {
+        strncpy(done[donecount++], text, 23);
+    }
+}
+
+static void run(mizraith_HDSP2111 &hdsp, unsigned long ms) {
+    for (unsigned long i = 0; i < ms; i++) {
+        hdsp.GoDogGo();
+        bus_model::advanceMs(1);
+    }
+}
+
+static void start(mizraith_HDSP2111 &hdsp) {
+    donecount = 0;
+    startOnBus(hdsp);
+    hdsp.setMessageCompleteCallback(messageDone);
+}
+
+
+int main(void) {
+    //a short static message with default arguments reaches the chip
+    //and stays up for a scroll delay before it is retired
+    {
+        mizraith_HDSP2111 hdsp;
+        start(hdsp);
+        hdsp.queueMessage((char *) "HELLO", 1);
+        hdsp.GoDogGo();
+        CHECK_FRAME(0, "HELLO   ");
+        CHECK(donecount == 0);
+        run(hdsp, 60);
+        CHECK_FRAME(0, "HELLO   ");
+        CHECK(donecount == 0);
+        run(hdsp, 200);
+        CHECK(donecount == 1);
+        CHECK(strcmp(done[0], "HELLO") == 0);
+        CHECK_FRAME(0, "        ");
+    }
+    
+    //repeats of a static message each get their dwell
+    {
+        mizraith_HDSP2111 hdsp;
+        start(hdsp);
+        hdsp.queueMessage((char *) "TWICE", 1, 0, 2, 300);
+        run(hdsp, 400);
+        CHECK(donecount == 0);
+        CHECK_FRAME(0, "TWICE   ");
+        run(hdsp, 300);
+        CHECK(donecount == 1);
+    }
+    
+    //an alarm interrupts a ticker, which picks up again afterwards
+    {
+        mizraith_HDSP2111 hdsp;
+        start(hdsp);
+        hdsp.queueMessage((char *) "ticker ticker ticker", 1, 0, 0);
+        hdsp.queueMessage((char *) "NEXT", 1, 0, 1, 200);
+        run(hdsp, 500);
+        CHECK(hdsp.queueMessage((char *) "ALARM!", 1, 5, 1, 200));
+        hdsp.GoDogGo();
+        CHECK_FRAME(0, "ALARM!  ");
+        run(hdsp, 10000);
+        CHECK(donecount == 3);
+        CHECK(strcmp(done[0], "ALARM!") == 0);
+        CHECK(strcmp(done[1], "ticker ticker ticker") == 0);
+        CHECK(strcmp(done[2], "NEXT") == 0);
+        CHECK(!hdsp.isMessageQueueActive(1));
+    }
+    
+    //full queue refuses more
+    {
+        mizraith_HDSP2111 hdsp;
+        start(hdsp);
+        uint8_t accepted = 0;
+        for (uint8_t i = 0; i < 10; i++) {
+            accepted += hdsp.queueMessage((char *) "X", 2) ? 1 : 0;
+        }
+        CHECK(accepted == 5);             //one showing, MESSAGE_QUEUE_SIZE waiting
+        CHECK(hdsp.getMessageQueueCount(2) == 4);
+    }
+
+    //an alarm still gets through a queue full of tickers, the lowest
+    //waiting one makes room and the interrupted one is shown again
+    {
+        mizraith_HDSP2111 hdsp;
+        start(hdsp);
+        static const char *tickers[] = { "TICK 0", "TICK 1", "TICK 2", "TICK 3", "TICK 4" };
+        for (uint8_t i = 0; i < 5; i++) {
+            CHECK(hdsp.queueMessage((char *) tickers[i], 1));
+        }
+        CHECK(!hdsp.queueMessage((char *) "TICK 5", 1));
+        CHECK(hdsp.queueMessage((char *) "ALARM", 1, 9));
+        CHECK(hdsp.getMessageQueueCount(1) == 4);
+        run(hdsp, 5000);
+        CHECK(donecount == 5);
+        CHECK(strcmp(done[0], "ALARM") == 0);
+        CHECK(strcmp(done[1], "TICK 0") == 0);
+        CHECK(strcmp(done[2], "TICK 1") == 0);
+        CHECK(strcmp(done[3], "TICK 2") == 0);
+        CHECK(strcmp(done[4], "TICK 3") == 0);
+    }
+
+    //without preempting, a full queue takes a message that outranks
+    //its lowest waiting one
+    {
+        mizraith_HDSP2111 hdsp;
+        start(hdsp);
+        hdsp.queueMessage((char *) "SHOWING", 1, 5);
+        for (uint8_t i = 0; i < 4; i++) {
+            CHECK(hdsp.queueMessage((char *) "LOW", 1, 1));
+        }
+        CHECK(!hdsp.queueMessage((char *) "LOW", 1, 1));
+        CHECK(hdsp.queueMessage((char *) "MID", 1, 3));
+        CHECK(hdsp.getMessageQueueCount(1) == 4);
+        run(hdsp, 5000);
+        CHECK(donecount == 5);
+        CHECK(strcmp(done[0], "SHOWING") == 0);
+        CHECK(strcmp(done[1], "MID") == 0);
+        CHECK(strcmp(done[4], "LOW") == 0);
+    }
+
+    return HOST_TEST_RESULT("test_message_queue");
+}
@@ -0,0 +1,115 @@
+/***************************************************
+  Delta-encoded scroll cache against the live path:
+  same frames, fewer bus bytes, and in-place edits
+  still show up.  Also prints time and bytes/step.
+ ****************************************************/
+#include <chrono>
+#include "host_test.h"
+
+static const uint16_t STEPS = 500;
+
+struct scroll_run {
+    char          FRAMES[STEPS][8];
+    unsigned long BYTES;
+    unsigned long CALLS;
+    double        US;
+};
+
+static uint8_t cachebuffer[600];
+
+static void scroll(const char *text, bool cached, scroll_run &result) {
+    static char textcopy[128];
+    strncpy(textcopy, text, sizeof(textcopy) - 1);
+    
+    mizraith_HDSP2111 hdsp;
+    startOnBus(hdsp);
+    if (cached) {
+        hdsp.setScrollCache(cachebuffer, sizeof(cachebuffer), 1);
+    }
+    hdsp.setDisplayStringAsNew(textcopy, 1);
+    CHECK(hdsp.isScrollCacheValid(1) == cached);
+    
+    unsigned long bytes = bus_model::BYTES;
+    unsigned long calls = bus_model::CALLS;
+    double us = 0;
+    for (uint16_t step = 0; step < STEPS; step++) {
+        bus_model::advanceMs(120);
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        hdsp.updateDisplayScroll(1);
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+        us += std::chrono::duration<double, std::micro>(t1 - t0).count();
+        hdsp.automaticallyResetScrollFlagAndPosition(1);
+        memcpy(result.FRAMES[step], bus_model::CHIPS[0].RAM, 8);
+    }
+    result.BYTES = bus_model::BYTES - bytes;
+    result.CALLS = bus_model::CALLS - calls;
+    result.US = us;
+    CHECK(bus_model::VIOLATIONS == 0);
+}
+
+static void compare(const char *name, const char *text) {
+    static scroll_run live;
+    static scroll_run cached;
+    scroll(text, false, live);
+    scroll(text, true, cached);
+    
+    CHECK(memcmp(live.FRAMES, cached.FRAMES, sizeof(live.FRAMES)) == 0);
+    CHECK(cached.BYTES <= live.BYTES);
+    printf("  %-10s bytes/step live %.1f cached %.1f   calls/step live %.1f cached %.1f   us/step live %.2f cached %.2f\n",
+           name, (double) live.BYTES / STEPS, (double) cached.BYTES / STEPS,
+           (double) live.CALLS / STEPS, (double) cached.CALLS / STEPS,
+           live.US / STEPS, cached.US / STEPS);
+}
+
+
+int main(void) {
+    compare("prose", "The quick brown fox jumps over the lazy dog");
+    compare("marquee", "*** ***  *** ***  SALE  *** ***  *** ***");
+    
+    //a marquee with repeats only writes what moves
+    {
+        static scroll_run live;
+        static scroll_run cached;
+        scroll("--------ALERT--------", false, live);
+        scroll("--------ALERT--------", true, cached);
+        CHECK(cached.BYTES * 2 < live.BYTES);
+    }
+    
+    //string edited in place (same length) is picked up on the next pass
+    {
+        static char text[] = "first version of the text";
+        mizraith_HDSP2111 hdsp;
+        startOnBus(hdsp);
+        hdsp.setScrollCache(cachebuffer, sizeof(cachebuffer), 1);
+        hdsp.setDisplayStringAsNew(text, 1);
+        for (uint8_t i = 0; i < 10; i++) {
+            bus_model::advanceMs(120);
+            hdsp.GoDogGo();
+        }
+        memcpy(text, "EDIT!", 5);
+        //finish this pass, then start the next
+        while (!hdsp.isScrollComplete(1)) {
+            bus_model::advanceMs(120);
+            hdsp.updateDisplays();
+        }
+        bus_model::advanceMs(120);
+        hdsp.GoDogGo();
+        CHECK_FRAME(0, "EDIT! ve");
+        CHECK(hdsp.isScrollCacheValid(1));
+
+        //+d -2d +d leaves any 8-bit running sum alone, the copy still sees it
+        static char reading[] = "TEMP=135C ok....";
+        hdsp.setDisplayStringAsNew(reading, 1);
+        while (!hdsp.isScrollComplete(1)) {
+            bus_model::advanceMs(120);
+            hdsp.updateDisplays();
+        }
+        memcpy(reading, "TEMP=216C", 9);
+        bus_model::advanceMs(120);
+        hdsp.GoDogGo();
+        CHECK_FRAME(0, "TEMP=216");
+        CHECK(hdsp.isScrollCacheValid(1));
+    }
+
+    return HOST_TEST_RESULT("test_scroll_cache");
+}
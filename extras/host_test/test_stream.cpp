@@ -0,0 +1,92 @@
+/***************************************************
+  Streaming text source: a synthetic ticker pushed
+  through a small ring buffer with backpressure.
+ ****************************************************/
+#include "host_test.h"
+
+static const uint16_t TICKER_REPEATS = 20;
+
+static void start(mizraith_HDSP2111 &hdsp, char *ring, uint8_t size, uint8_t idlemode) {
+    startOnBus(hdsp);
+    hdsp.beginStream(ring, size, 1, idlemode);
+}
+
+
+int main(void) {
+    //a stream far longer than 255 chars, fed as fast as the ring allows;
+    //every char has to come out on the right-hand side in order
+    {
+        mizraith_HDSP2111 hdsp;
+        char ring[16];
+        start(hdsp, ring, sizeof(ring), HDSP_STREAM_IDLE_BLANK);
+        
+        const char *ticker = "NEWS: markets up 3%, sunny, more at eleven... ";
+        uint16_t tickerlength = strlen(ticker);
+        uint32_t total = (uint32_t) tickerlength * TICKER_REPEATS;
+        uint32_t sent = 0;
+        uint32_t seen = 0;
+        bool inorder = true;
+        bool refused = false;
+        
+        for (uint32_t loop = 0; loop < total * 2 + 20; loop++) {
+            while (sent < total) {
+                if (!hdsp.streamWrite(ticker[sent % tickerlength], 1)) {
+                    refused = true;          //ring full, try again next loop
+                    break;
+                }
+                sent++;
+            }
+            CHECK(hdsp.getStreamSpace(1) <= sizeof(ring));
+            
+            //one SCROLL_DELAY per loop, so each call brings in one char
+            bus_model::advanceMs(120);
+            hdsp.GoDogGo();
+            if (seen < total) {
+                if (bus_model::CHIPS[0].RAM[7] != ticker[seen % tickerlength]) {
+                    inorder = false;
+                }
+                seen++;
+            }
+        }
+        CHECK(total > 255);
+        CHECK(refused);
+        CHECK(sent == total);
+        CHECK(seen == total);
+        CHECK(inorder);
+        CHECK_FRAME(0, "        ");         //padded out once the stream ran dry
+        CHECK(hdsp.getTimeUntilNextUpdate(1) == HDSP_NO_DEADLINE);
+        CHECK(bus_model::VIOLATIONS == 0);
+    }
+    
+    //hold mode leaves the last chars up when the stream runs dry
+    {
+        mizraith_HDSP2111 hdsp;
+        char ring[8];
+        start(hdsp, ring, sizeof(ring), HDSP_STREAM_IDLE_HOLD);
+        CHECK(hdsp.streamWrite("ABCDEFGHIJ", 10, 1) == 8);        //backpressure
+        for (uint8_t i = 0; i < 20; i++) {
+            bus_model::advanceMs(120);
+            hdsp.GoDogGo();
+        }
+        CHECK_FRAME(0, "ABCDEFGH");
+        CHECK(hdsp.getTimeUntilNextUpdate(1) == HDSP_NO_DEADLINE);
+        CHECK(hdsp.streamWrite('I', 1));
+        CHECK(hdsp.getTimeUntilNextUpdate(1) == 0);
+        hdsp.GoDogGo();
+        CHECK_FRAME(0, "BCDEFGHI");
+        
+        //back to the ordinary display string
+        hdsp.endStream(1);
+        CHECK(!hdsp.isStreaming(1));
+        CHECK(!hdsp.streamWrite('J', 1));
+        hdsp.setDisplayStringAsNew((char *) "static", 1);
+        hdsp.GoDogGo();
+        CHECK_FRAME(0, "static  ");
+        
+        //no display 0 to stream to
+        CHECK(hdsp.streamWrite("KL", 2, 0) == 0);
+        CHECK(hdsp.getStreamSpace(0) == 0);
+    }
+    
+    return HOST_TEST_RESULT("test_stream");
+}
@@ -0,0 +1,120 @@
+/***************************************************
+  Tickless operation on a virtual clock.
+
+  The same script is run twice: once calling GoDogGo
+  every millisecond, once sleeping until
+  getTimeUntilNextUpdate() says there is work.  Every
+  change on the chips has to happen in the same order
+  and no later than when polling, i.e. no deadline
+  is missed.
+ ****************************************************/
+#include "host_test.h"
+
+static const unsigned long RUN_MS = 12000;
+static const uint16_t      MAX_LOG = 600;
+
+struct frame_change {
+    unsigned long MS;
+    char          RAM[2][8];
+};
+
+static frame_change  changes[2][MAX_LOG];
+static uint16_t      changecount[2];
+
+static void logChanges(uint8_t run) {
+    frame_change *last = changecount[run] ? &changes[run][changecount[run]-1] : NULL;
+    if (last && memcmp(last->RAM[0], bus_model::CHIPS[0].RAM, 8) == 0 
+             && memcmp(last->RAM[1], bus_model::CHIPS[1].RAM, 8) == 0) {
+        return;
+    }
+    if (changecount[run] < MAX_LOG) {
+        frame_change *c = &changes[run][changecount[run]++];
+        c->MS = bus_model::clockMs();
+        memcpy(c->RAM[0], bus_model::CHIPS[0].RAM, 8);
+        memcpy(c->RAM[1], bus_model::CHIPS[1].RAM, 8);
+    }
+}
+
+static void script(mizraith_HDSP2111 &hdsp) {
+    hdsp.queueMessage((char *) "HELLO", 1);
+    hdsp.queueMessage((char *) "then a scrolling one", 1);
+    hdsp.queueMessage((char *) "BYE", 1, 0, 2, 500);
+    hdsp.queueMessage((char *) "IDLE", 1, 0, 0);
+    hdsp.setDisplayStringAsNew((char *) "display two keeps scrolling", 2);
+}
+
+
+int main(void) {
+    unsigned long calls[2];
+    
+    for (uint8_t run = 0; run < 2; run++) {
+        mizraith_HDSP2111 hdsp;
+        startOnBus(hdsp);
+        script(hdsp);
+        
+        calls[run] = 0;
+        uint8_t zeros = 0;
+        while (bus_model::clockMs() < RUN_MS) {
+            hdsp.GoDogGo();
+            calls[run]++;
+            logChanges(run);
+            
+            unsigned long wait = 1;
+            if (run == 1) {
+                wait = hdsp.getTimeUntilNextUpdate();
+            }
+            if (wait == 0) {
+                CHECK(++zeros < 3);                //due again right away means spinning
+                if (zeros >= 3) {
+                    break;
+                }
+            } else {
+                zeros = 0;
+            }
+            if (wait == HDSP_NO_DEADLINE) {
+                wait = RUN_MS - bus_model::clockMs();
+            }
+            //strobe waits leave the clock a little past the ms, both runs
+            //step on whole ms so they see the same times
+            unsigned long long target = (bus_model::clockMs() + wait) * 1000000ULL;
+            bus_model::NOW_NS = target;
+        }
+    }
+    
+    CHECK(changecount[0] > 100);
+    CHECK(changecount[0] == changecount[1]);
+    for (uint16_t i = 0; i < changecount[0] && i < changecount[1]; i++) {
+        //tickless may act up to 1ms sooner: polling only gets round to
+        //work that is due "on the next call" a millisecond later
+        unsigned long polled = changes[0][i].MS;
+        unsigned long tickless = changes[1][i].MS;
+        CHECK(tickless <= polled && polled - tickless <= 1);
+        CHECK(memcmp(changes[0][i].RAM, changes[1][i].RAM, 16) == 0);
+        if (tickless > polled || polled - tickless > 1) {
+            printf("  change %u: polled at %lu ms, tickless at %lu ms\n", i, polled, tickless);
+            break;
+        }
+    }
+    CHECK(calls[1] * 5 < calls[0]);
+    printf("  GoDogGo calls: polled %lu, tickless %lu\n", calls[0], calls[1]);
+    
+    //A looping static message with nothing behind it has no deadline
+    {
+        mizraith_HDSP2111 hdsp;
+        startOnBus(hdsp);
+        hdsp.queueMessage((char *) "IDLE", 1, 0, 0);
+        hdsp.GoDogGo();
+        CHECK_FRAME(0, "IDLE    ");
+        bus_model::advanceMs(1000);
+        hdsp.GoDogGo();
+        CHECK(hdsp.getTimeUntilNextUpdate() == HDSP_NO_DEADLINE);
+        //...until something else is queued
+        hdsp.queueMessage((char *) "NEXT", 1);
+        CHECK(hdsp.getTimeUntilNextUpdate() == 0);
+        hdsp.GoDogGo();
+        hdsp.GoDogGo();
+        CHECK_FRAME(0, "NEXT    ");
+    }
+    
+    return HOST_TEST_RESULT("test_tickless");
+}
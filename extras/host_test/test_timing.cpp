@@ -0,0 +1,85 @@
+/***************************************************
+  Strobe timing (timing profiles) on the bus model.
+  
+  Every write/read cycle is checked for edge order
+  and the minimum gaps in HDSP_TIMING_DATASHEET.
+ ****************************************************/
+#include "host_test.h"
+
+//An I2C register access takes at least this long even at 1.7MHz
+static const uint32_t I2C_STEP_NS = 20000;
+
+static unsigned long long frameDelay(mizraith_HDSP2111 &hdsp) {
+    unsigned long long before = bus_model::DELAY_NS;
+    hdsp.writeDisplay((char *) "12345678", 1);
+    return bus_model::DELAY_NS - before;
+}
+
+//The usual traffic: static text, brightness (read back), scrolling
+static void exercise(mizraith_HDSP2111 &hdsp) {
+    hdsp.setBrightnessForAllDisplays(2);
+    hdsp.setDisplayStringAsNew((char *) "Timing", 1);
+    hdsp.setDisplayStringAsNew((char *) "A longer scrolling string", 2);
+    for (uint8_t i = 0; i < 40; i++) {
+        bus_model::advanceMs(150);
+        hdsp.updateDisplays();
+    }
+}
+
+
+int main(void) {
+    //MCP23017 profile over I2C: all minimums met without any waits
+    {
+        mizraith_HDSP2111 hdsp;
+        startOnBus(hdsp, NULL, I2C_STEP_NS);
+        exercise(hdsp);
+        CHECK(bus_model::VIOLATIONS == 0);
+        CHECK(bus_model::DELAY_NS == 0);
+        CHECK_FRAME(0, "Timing  ");
+        CHECK_FRAME(1, "        ");
+        CHECK(bus_model::CHIPS[0].CONTROL == 0x02);
+        CHECK(bus_model::CHIPS[1].CONTROL == 0x02);
+        CHECK(frameDelay(hdsp) == 0);
+        if (bus_model::VIOLATIONS) {
+            printf("  mcp23017: %s\n", bus_model::LAST_VIOLATION);
+        }
+    }
+    
+    //Datasheet profile on a transport with no delay of its own
+    {
+        mizraith_HDSP2111 hdsp;
+        startOnBus(hdsp);
+        exercise(hdsp);
+        CHECK(bus_model::VIOLATIONS == 0);
+        CHECK(bus_model::DELAY_NS > 0);
+        CHECK_FRAME(0, "Timing  ");
+        CHECK(bus_model::CHIPS[1].CONTROL == 0x02);
+        unsigned long long ns = frameDelay(hdsp);
+        CHECK(ns > 0 && ns < 1000000ULL);             //well under a millisecond
+        printf("  datasheet profile: %llu ns of waits per frame\n", ns);
+        if (bus_model::VIOLATIONS) {
+            printf("  datasheet: %s\n", bus_model::LAST_VIOLATION);
+        }
+    }
+    
+    //...and the checker does catch the MCP23017 profile on that fast transport
+    {
+        mizraith_HDSP2111 hdsp;
+        startOnBus(hdsp, NULL);
+        exercise(hdsp);
+        CHECK(bus_model::VIOLATIONS > 0);
+    }
+    
+    //Minimums past 32us must not wrap in strobeWait's arithmetic
+    {
+        const hdsp2111_timing_profile slow = { 40000, 40000, 40000, 40000, 0 };
+        mizraith_HDSP2111 hdsp;
+        startOnBus(hdsp, &slow, 0, slow);
+        unsigned long long ns = frameDelay(hdsp);
+        CHECK(ns >= 8ULL * 3 * 40000);
+        CHECK(bus_model::VIOLATIONS == 0);
+        CHECK_FRAME(0, "12345678");
+    }
+    
+    return HOST_TEST_RESULT("test_timing");
+}
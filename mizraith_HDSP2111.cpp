@@ -10,6 +10,14 @@
 #include "mizraith_HDSP2111.h"
 
 
+//  From datasheet (worst case, Vcc = 4.5V) ---------------
+//  tAS 10  tDS 50  tW 100  tAH/tDH 20  tACC 210     (ns)
+//  An MCP23017 register write takes ~20us even at 1.7MHz I2C.
+//-------------------------------------------------------
+const hdsp2111_timing_profile HDSP_TIMING_MCP23017  = { 50, 100, 20, 210, 20000 };
+const hdsp2111_timing_profile HDSP_TIMING_DATASHEET = { 50, 100, 20, 210, 0 };
+
+
 
 mizraith_HDSP2111::mizraith_HDSP2111(void) {
     BLANK_STRING = "        ";     
@@ -22,7 +30,27 @@ mizraith_HDSP2111::mizraith_HDSP2111(void) {
         DISPLAY_DATA[i].SCROLL_DELAY = 120;
         DISPLAY_DATA[i].SCROLL_COMPLETE = false;
         DISPLAY_DATA[i].TEXT_CHANGED = false;
+        memset(DISPLAY_DATA[i].FRAME, 0, 8);
+        DISPLAY_DATA[i].CACHE = NULL;
+        DISPLAY_DATA[i].CACHE_SIZE = 0;
+        DISPLAY_DATA[i].CACHE_LENGTH = 0;
+        DISPLAY_DATA[i].CACHE_OFFSET = 0;
+        DISPLAY_DATA[i].CACHE_SYNCED = false;
+        DISPLAY_DATA[i].CACHE_TEXT_LENGTH = 0;
+        DISPLAY_DATA[i].STREAM_BUFFER = NULL;
+        DISPLAY_DATA[i].STREAM_SIZE = 0;
+        DISPLAY_DATA[i].STREAM_HEAD = 0;
+        DISPLAY_DATA[i].STREAM_COUNT = 0;
+        DISPLAY_DATA[i].STREAM_IDLE = HDSP_STREAM_IDLE_HOLD;
+        DISPLAY_DATA[i].STREAM_PADDING = 0;
+        MESSAGE_QUEUE[i].COUNT = 0;
+        MESSAGE_QUEUE[i].ACTIVE = false;
+        MESSAGE_QUEUE[i].PASS_SHOWN = false;
+        MESSAGE_QUEUE[i].PASS_START = 0;
     }
+    MESSAGE_CALLBACK = NULL;
+    CLOCK_SOURCE = millis;
+    TIMING = &HDSP_TIMING_MCP23017;
 }
 
 
@@ -58,7 +86,7 @@ void mizraith_HDSP2111::setup(uint8_t mcpaddr) {
   mcp_display.writePin(HDSP_WR, HIGH);
   
   for(uint8_t i=0; i<NUMBER_OF_DISPLAYS;  i++ ) {
-    DISPLAY_DATA[i].LAST_UPDATE = millis();
+    DISPLAY_DATA[i].LAST_UPDATE = now();
   }
 }
 
@@ -66,6 +94,7 @@ void mizraith_HDSP2111::setup(uint8_t mcpaddr) {
 //SUPER EASY CONVENIENCE METHOD  
 //Intended to be called once per loop() to keep scrolling and updating going
 void mizraith_HDSP2111::GoDogGo(void) {
+    updateMessageQueues();
     automaticallyResetScrollFlagAndPositions();
     updateDisplays();
 } 
@@ -74,12 +103,16 @@ void mizraith_HDSP2111::GoDogGo(void) {
 
 
 /**
- * Routine for clearing out ALL displays.
+ * Routine for clearing out ALL displays.  The blank frame and 
+ * control word are the same for every display, so they go out
+ * once to all of them together.
  */
 void mizraith_HDSP2111::resetDisplays() {
   for(uint8_t displaynum=1; displaynum <= NUMBER_OF_DISPLAYS; displaynum++) {
-      resetDisplay(displaynum);
+      resetDisplayData(displaynum);
   }
+  writeDisplays(BLANK_STRING, HDSP_ALL_DISPLAYS);
+  writeControlWord(0x00, HDSP_ALL_DISPLAYS);
 }
 
 /**
@@ -90,91 +123,127 @@ void mizraith_HDSP2111::resetDisplays() {
  *
  */
 void mizraith_HDSP2111::resetDisplay(uint8_t displaynum) {
-    if( displaynum > NUMBER_OF_DISPLAYS) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
         return;
     } else {
-       uint8_t displayindex = displaynum-1;
-       
-       DISPLAY_DATA[displayindex].LAST_UPDATE = millis();
-       DISPLAY_DATA[displayindex].TEXT = BLANK_STRING;
-       DISPLAY_DATA[displayindex].TEXT_LENGTH = 8;
-       DISPLAY_DATA[displayindex].SCROLL_POSITION = 0;
-       DISPLAY_DATA[displayindex].SCROLL_COMPLETE = false;
-       DISPLAY_DATA[displayindex].TEXT_CHANGED = false;
-       
-       writeDisplay(DISPLAY_DATA[displayindex].TEXT, displaynum);
+       resetDisplayData(displaynum);
+       writeDisplay(DISPLAY_DATA[displaynum-1].TEXT, displaynum);
        clearControlWord(displaynum);
    }
 }
 
 
+void mizraith_HDSP2111::resetDisplayData(uint8_t displaynum) {
+    uint8_t displayindex = displaynum-1;
+       
+    DISPLAY_DATA[displayindex].LAST_UPDATE = now();
+    DISPLAY_DATA[displayindex].TEXT = BLANK_STRING;
+    DISPLAY_DATA[displayindex].TEXT_LENGTH = 8;
+    DISPLAY_DATA[displayindex].SCROLL_POSITION = 0;
+    DISPLAY_DATA[displayindex].SCROLL_COMPLETE = false;
+    DISPLAY_DATA[displayindex].TEXT_CHANGED = false;
+}
+
 
 
 
 void mizraith_HDSP2111::clearControlWord(uint8_t displaynum) {
+    writeControlWord(0x00, HDSP_DISPLAY_MASK(displaynum));
+}
+
+
+/**
+ * Writes the control word to every display in displaymask
+ * in one go.
+ */
+void mizraith_HDSP2111::writeControlWord(uint8_t controlword, uint8_t displaymask) {
     uint8_t portA = 0;
-    uint8_t dispCE = getDisplayCEFromDisplayNum(displaynum);     
+    //first, set up our control and address signals
+    //  #RST  #CE   #WR   #RD
+    //   1    0     0     1       (#RST and #RD are typically held high all the time)
+    //  #FL   A4  A3  A2  A1  A0
+    //   1    1   0   x   x    x     On our board #FL and A4 is typically also held high all the time.
     portA &= 0xF0;      //clear GPA0:3 == A0:3 bits before rebuilding
     portA |= 0xF0;      //set GPA4:7 == #RD, #WR, U1CE1, U2CE2 to high
     
-    uint8_t controlbyte = 0x00;   
+    strobeWrite(portA, controlword, displaymask);
+}
+
+
+/**
+ * One write cycle on the shared bus.  portA carries the address with
+ * #RD, #WR and both CE lines high.  Every CE line in displaymask is
+ * pulled low together, so each of those displays latches the same
+ * data from the one strobe.  
+ */
+void mizraith_HDSP2111::strobeWrite(uint8_t portA, uint8_t data, uint8_t displaymask) {
+    uint8_t ce = getCEBitsFromDisplayMask(displaymask);
+    uint8_t wr = (1 << HDSP_WR);
+    if (ce == 0) {
+        return;
+    }
+    
+    //Put these out on the ports, then toggle write pins
     mcp_display.writeGPIOA(portA);
-    mcp_display.writeGPIOB(controlbyte);
-    delay(1);
+    mcp_display.writeGPIOB(data);
+    strobeWait(TIMING->ADDRESS_SETUP_NS);
     //now toggle
-    mcp_display.writePin(dispCE, LOW);
-    delay(1);
-    mcp_display.writePin(HDSP_WR, LOW);
-    delay(1);
-    mcp_display.writePin(HDSP_WR, HIGH);
-    delay(1);
-    mcp_display.writePin(dispCE, HIGH);
-    delay(1);
+    mcp_display.writeGPIOA(portA & ~ce);
+    mcp_display.writeGPIOA(portA & ~ce & ~wr);
+    strobeWait(TIMING->WRITE_PULSE_NS);
+    mcp_display.writeGPIOA(portA & ~ce);         //#WR rising latches the data
+    strobeWait(TIMING->HOLD_NS);
+    mcp_display.writeGPIOA(portA);
 }
 
 //set brightness using corresponding 3 bit value, were 0x00 = 100% and 0x07= 0%
 //in this case, however, we do not allow a 0x07, so as to prevent completely blanking display.
 void mizraith_HDSP2111::setBrightnessForAllDisplays(uint8_t value) {
-    if (value >=7 ) {     //7 = off....ignore that.
-        return;  //do nothing.
-    }
-    for(uint8_t displaynum=1; displaynum <= NUMBER_OF_DISPLAYS; displaynum++) {
-          setBrightnessForDisplay(value, displaynum);
-    }
+    setBrightnessForDisplays(value, HDSP_ALL_DISPLAYS);
 }
 
 void mizraith_HDSP2111::setBrightnessForDisplay(uint8_t value, uint8_t displaynum) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
+        Serial.println(F("!!!! ERROR UNDEFINED DISPLAY ADDRESS (setBrightnessForDisplay) !!!!!"));
+        return;
+    }
+    setBrightnessForDisplays(value, HDSP_DISPLAY_MASK(displaynum));
+}
+
+//Reads back each display's control word (reads can't be shared), swaps
+//in the new brightness bits, then writes each distinct word only once
+//to all of the displays that end up with it.
+void mizraith_HDSP2111::setBrightnessForDisplays(uint8_t value, uint8_t displaymask) {
     if (value >=7 ) {     //7 = off....ignore that.
         return;  //do nothing.
     }
-    uint8_t portA = 0;
-    uint8_t dispCE = getDisplayCEFromDisplayNum(displaynum);  
-    //first, set up our control and address signals
-    //  #RST  #CE   #WR   #RD
-    //   1    0     0     1       (#RST and #RD are typically held high all the time)
-    //  #FL   A4  A3  A2  A1  A0
-    //   1    1   0   x   x    x     On our board #FL and A4 is typically also held high all the time.
-    portA &= 0xF0;      //clear GPA0:3 == A0:3 bits before rebuilding
-    portA |= 0xF0;      //set GPA4:7 == #RD, #WR, U1CE1, U2CE2 to high
+    uint8_t controldata[NUMBER_OF_DISPLAYS];
+    uint8_t pending = 0;
     
-    uint8_t controldata = getDisplayControlRegister(displaynum);
-
-    controldata &= 0xF8;       //clear out last 3 bits, leave rest untouched
-    //controldata = 0x00;      //CLOBBER IT ALL.   Option if the readback is not working!
-    controldata |= value;    //or in new brightnessbits
+    for(uint8_t i=0; i < NUMBER_OF_DISPLAYS; i++) {
+        if ( !(displaymask & (1 << i)) ) {
+            continue;
+        }
+        controldata[i] = getDisplayControlRegister(i+1);
+        controldata[i] &= 0xF8;       //clear out last 3 bits, leave rest untouched
+        //controldata[i] = 0x00;      //CLOBBER IT ALL.   Option if the readback is not working!
+        controldata[i] |= value;    //or in new brightnessbits
+        pending |= (1 << i);
+    }
     
-    mcp_display.writeGPIOA(portA);
-    mcp_display.writeGPIOB(controldata);
-    delay(1);
-    //now toggle
-    mcp_display.writePin(dispCE, LOW);
-    delay(1);
-    mcp_display.writePin(HDSP_WR, LOW);
-    delay(1);
-    mcp_display.writePin(HDSP_WR, HIGH);
-    delay(1);
-    mcp_display.writePin(dispCE, HIGH);
-    delay(1);
+    for(uint8_t i=0; i < NUMBER_OF_DISPLAYS; i++) {
+        if ( !(pending & (1 << i)) ) {
+            continue;
+        }
+        uint8_t group = 0;
+        for(uint8_t j=i; j < NUMBER_OF_DISPLAYS; j++) {
+            if ( (pending & (1 << j)) && (controldata[j] == controldata[i]) ) {
+                group |= (1 << j);
+            }
+        }
+        pending &= ~group;
+        writeControlWord(controldata[i], group);
+    }
 }
 
 
@@ -215,18 +284,17 @@ uint8_t mizraith_HDSP2111::getDisplayControlRegister(uint8_t displaynum) {
       mcp_display.setGPIOBMode(0x11);     // 1=input 0=output  set all as outputs
       mcp_display.writeGPIOA(portA);
       mcp_display.writeGPIOB(0x00);       //It seems I have to do this or I get erroneous readbacks
+      strobeWait(TIMING->ADDRESS_SETUP_NS);
       //now toggle
       mcp_display.writePin(dispCE, LOW);
-      delay(1);
       mcp_display.writePin(HDSP_RD, LOW);
-      delay(3);
+      strobeWait(TIMING->READ_ACCESS_NS);
       //load into local byte BEFORE releasing READ pin
       uint8_t controldata = mcp_display.readGPIOB();
       controldata = mcp_display.readGPIOB();
       mcp_display.writePin(HDSP_RD, HIGH);
-      delay(1);
+      strobeWait(TIMING->HOLD_NS);
       mcp_display.writePin(dispCE, HIGH);
-      delay(1);      
         
       //set ot back as an output
       mcp_display.setGPIOBMode(0x00);     // 1=input 0=output  set all as outputs
@@ -237,7 +305,7 @@ uint8_t mizraith_HDSP2111::getDisplayControlRegister(uint8_t displaynum) {
 
 
 bool mizraith_HDSP2111::isScrollComplete(uint8_t displaynum) {
-    if(displaynum > NUMBER_OF_DISPLAYS) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
         return false;
     } else {
         bool sc = DISPLAY_DATA[displaynum-1].SCROLL_COMPLETE;
@@ -247,7 +315,7 @@ bool mizraith_HDSP2111::isScrollComplete(uint8_t displaynum) {
 
 
 void mizraith_HDSP2111::setScrollCompleteFlag(bool flag, uint8_t displaynum) {
-    if( displaynum > NUMBER_OF_DISPLAYS) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
         return;
     } else {
         DISPLAY_DATA[displaynum-1].SCROLL_COMPLETE = flag;
@@ -256,17 +324,22 @@ void mizraith_HDSP2111::setScrollCompleteFlag(bool flag, uint8_t displaynum) {
 
 
 void mizraith_HDSP2111::setScrollPosition(uint8_t pos, uint8_t displaynum) {
-    if( displaynum > NUMBER_OF_DISPLAYS) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
         return;
     } else {
         DISPLAY_DATA[displaynum-1].SCROLL_POSITION = pos;    
+        DISPLAY_DATA[displaynum-1].CACHE_SYNCED = false;    //cache picks up again at 0
     }
 }
 	
 // Automatically reset both scroll complete flag and scroll position for 
-// both displays.
+// both displays.  Displays driven by their message queue are skipped, 
+// the queue decides when those restart.
 void mizraith_HDSP2111::automaticallyResetScrollFlagAndPositions(void) {
     for(uint8_t i=1; i <= NUMBER_OF_DISPLAYS; i++) {
+        if (MESSAGE_QUEUE[i-1].ACTIVE) {
+            continue;
+        }
         automaticallyResetScrollFlagAndPosition(i);
     }
 }	
@@ -325,7 +398,7 @@ void mizraith_HDSP2111::setScrollSpeedForAllDisplays(uint8_t value) {
 	  
 //Set the delay in (ms) between scroll steps	  
 void mizraith_HDSP2111::setScrollDelay(uint16_t delayms, uint8_t displaynum) {
-  if( displaynum-1 < NUMBER_OF_DISPLAYS) {
+  if( (displaynum != 0) && (displaynum <= NUMBER_OF_DISPLAYS) ) {
       DISPLAY_DATA[displaynum-1].SCROLL_DELAY = delayms;
   }
 }
@@ -337,7 +410,7 @@ void mizraith_HDSP2111::setScrollDelay(uint16_t delayms, uint8_t displaynum) {
 //      if we are just editing one character of the string.
 // (3) OTHERWISE -- passes off to setDisplayStringAsNew moethod
 void mizraith_HDSP2111::setDisplayString(char *words, uint8_t displaynum) {
-    if(displaynum > NUMBER_OF_DISPLAYS) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
         return;
     }
     uint8_t displayindex = displaynum - 1;
@@ -348,6 +421,7 @@ void mizraith_HDSP2111::setDisplayString(char *words, uint8_t displaynum) {
         setDisplayStringAsNew(words, displaynum);  //different length, need to restart scroll
     } else {
         DISPLAY_DATA[displayindex].TEXT_CHANGED = true;
+        buildScrollCache(displaynum);
     }
 } 
     
@@ -356,7 +430,7 @@ void mizraith_HDSP2111::setDisplayString(char *words, uint8_t displaynum) {
 // the supporting variables.  Finally,
 // it sets the DISPLAYx_STRING_CHANGED variable to true to refresh static displays
 void mizraith_HDSP2111::setDisplayStringAsNew(char *words, uint8_t displaynum) {
-    if(displaynum > NUMBER_OF_DISPLAYS) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
       return;
     }
     uint8_t displayindex = displaynum - 1;
@@ -367,12 +441,13 @@ void mizraith_HDSP2111::setDisplayStringAsNew(char *words, uint8_t displaynum) {
     DISPLAY_DATA[displayindex].SCROLL_POSITION = 0;    
     DISPLAY_DATA[displayindex].SCROLL_COMPLETE = false;
     DISPLAY_DATA[displayindex].TEXT_CHANGED = true;
+    buildScrollCache(displaynum);
 }
 
 
 
 char * mizraith_HDSP2111::getDisplayString(uint8_t displaynum) {
-  if(displaynum > NUMBER_OF_DISPLAYS) {
+  if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
       return BLANK_STRING;
   } else {
       return DISPLAY_DATA[displaynum-1].TEXT;
@@ -383,6 +458,184 @@ char * mizraith_HDSP2111::getDisplayString(uint8_t displaynum) {
 
 
 
+//Give the display a buffer to hold pre-computed scroll steps, or NULL
+//to go back to building every step on the fly.
+void mizraith_HDSP2111::setScrollCache(uint8_t *buffer, uint16_t size, uint8_t displaynum) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
+        return;
+    }
+    DISPLAY_DATA[displaynum-1].CACHE = buffer;
+    DISPLAY_DATA[displaynum-1].CACHE_SIZE = (buffer == NULL) ? 0 : size;
+    buildScrollCache(displaynum);
+}
+
+
+bool mizraith_HDSP2111::isScrollCacheValid(uint8_t displaynum) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
+        return false;
+    }
+    return (DISPLAY_DATA[displaynum-1].CACHE_LENGTH > 0);
+}
+
+
+
+//Switch the display over to scrolling whatever gets pushed into buffer
+void mizraith_HDSP2111::beginStream(char *buffer, uint8_t size, uint8_t displaynum, uint8_t idlemode) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) || (buffer == NULL) || (size == 0) ) {
+        return;
+    }
+    display_data *data = &DISPLAY_DATA[displaynum-1];
+    data->STREAM_BUFFER = buffer;
+    data->STREAM_SIZE = size;
+    data->STREAM_HEAD = 0;
+    data->STREAM_COUNT = 0;
+    data->STREAM_IDLE = idlemode;
+    data->STREAM_PADDING = 8;        //nothing to pad out yet
+    data->SCROLL_COMPLETE = false;
+}
+
+
+//Drop anything still buffered and go back to the display string
+void mizraith_HDSP2111::endStream(uint8_t displaynum) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
+        return;
+    }
+    display_data *data = &DISPLAY_DATA[displaynum-1];
+    if (data->STREAM_BUFFER == NULL) {
+        return;
+    }
+    data->STREAM_BUFFER = NULL;
+    data->STREAM_COUNT = 0;
+    setDisplayStringAsNew(data->TEXT, displaynum);
+}
+
+
+bool mizraith_HDSP2111::isStreaming(uint8_t displaynum) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
+        return false;
+    }
+    return (DISPLAY_DATA[displaynum-1].STREAM_BUFFER != NULL);
+}
+
+
+//false if the ring is full (or the display isn't streaming)
+bool mizraith_HDSP2111::streamWrite(char c, uint8_t displaynum) {
+    return (streamWrite(&c, 1, displaynum) == 1);
+}
+
+
+//Copies in as much of data as fits and returns how much that was
+uint8_t mizraith_HDSP2111::streamWrite(const char *data, uint8_t length, uint8_t displaynum) {
+    uint8_t space = getStreamSpace(displaynum);
+    if (space == 0) {
+        return 0;          //full, not streaming, or no such display
+    }
+    if (length > space) {
+        length = space;
+    }
+    display_data *disp = &DISPLAY_DATA[displaynum-1];
+    for (uint8_t i = 0; i < length; i++) {
+        uint8_t tail = (disp->STREAM_HEAD + disp->STREAM_COUNT) % disp->STREAM_SIZE;
+        disp->STREAM_BUFFER[tail] = data[i];
+        disp->STREAM_COUNT++;
+    }
+    return length;
+}
+
+
+uint8_t mizraith_HDSP2111::getStreamSpace(uint8_t displaynum) {
+    if( !isStreaming(displaynum) ) {
+        return 0;
+    }
+    display_data *data = &DISPLAY_DATA[displaynum-1];
+    return data->STREAM_SIZE - data->STREAM_COUNT;
+}
+
+
+
+//Queue up a message for a display.  If it outranks the message currently
+//showing, it takes over right away and the interrupted message goes back
+//to the front of its priority group to be shown again afterwards.
+//If the queue is full, the last (lowest priority) waiting message is
+//dropped to make room, as long as the new one outranks it.
+//Returns false (and queues nothing) if the queue is full of messages
+//at least as important.
+bool mizraith_HDSP2111::queueMessage(char *words, uint8_t displaynum, uint8_t priority, uint8_t repeats, uint16_t dwellms) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
+        return false;
+    }
+    message_queue *queue = &MESSAGE_QUEUE[displaynum-1];
+    if (queue->COUNT >= MESSAGE_QUEUE_SIZE) {
+        if (priority <= queue->MESSAGES[queue->COUNT-1].PRIORITY) {
+            return false;
+        }
+        queue->COUNT--;          //evict, kept sorted so it's the last one
+    }
+    
+    queued_message msg;
+    msg.TEXT = words;
+    msg.PRIORITY = priority;
+    msg.REPEAT_COUNT = repeats;
+    msg.DWELL_TIME = dwellms;
+    
+    if (queue->ACTIVE && (priority > queue->CURRENT.PRIORITY)) {
+        //preempt -- we made room above
+        insertQueuedMessage(queue->CURRENT, displaynum, true);
+        queue->CURRENT = msg;
+        startMessagePass(displaynum);
+        return true;
+    }
+    
+    insertQueuedMessage(msg, displaynum, false);
+    if (!queue->ACTIVE) {
+        startQueuedMessage(displaynum);
+    }
+    return true;
+}
+
+
+//Drop everything waiting on the display.  Whatever is showing stays
+//up and goes back to the normal (auto-reset) scroll behavior.
+void mizraith_HDSP2111::clearMessageQueue(uint8_t displaynum) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
+        return;
+    }
+    MESSAGE_QUEUE[displaynum-1].COUNT = 0;
+    MESSAGE_QUEUE[displaynum-1].ACTIVE = false;
+}
+
+
+uint8_t mizraith_HDSP2111::getMessageQueueCount(uint8_t displaynum) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
+        return 0;
+    }
+    return MESSAGE_QUEUE[displaynum-1].COUNT;
+}
+
+
+bool mizraith_HDSP2111::isMessageQueueActive(uint8_t displaynum) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
+        return false;
+    }
+    return MESSAGE_QUEUE[displaynum-1].ACTIVE;
+}
+
+
+//Callback fires once a queued message has finished all of its repeats
+//(not when it is preempted).  It is safe to queue more messages from it.
+void mizraith_HDSP2111::setMessageCompleteCallback(HDSP2111MessageCallback callback) {
+    MESSAGE_CALLBACK = callback;
+}
+
+
+void mizraith_HDSP2111::updateMessageQueues(void) {
+    for(uint8_t i=1; i <= NUMBER_OF_DISPLAYS; i++) {
+        updateMessageQueue(i);
+    }
+}
+
+
+
 //RECOMMENDED METHOD #2
 //convenience method for updating both displays, whether
 //they be scrolling or static. This method should be
@@ -394,32 +647,69 @@ char * mizraith_HDSP2111::getDisplayString(uint8_t displaynum) {
 //    (b) displaystirng is long (>8 scrolling) AND marked as changed
 //    (c) displaystring is long (>8)....passed off to updateDisplayScroll
 //        to handle the scrolling of the display.
+//
+// Frames are worked out for every display first, then displays that
+// end up showing the same 8 chars get written together in one pass.
 void mizraith_HDSP2111::updateDisplays() {
+    char    frames[NUMBER_OF_DISPLAYS][8];
+    uint8_t positions[NUMBER_OF_DISPLAYS];
+    uint8_t pending = 0;
     
     for(uint8_t i=0; i < NUMBER_OF_DISPLAYS; i++) {
         uint8_t displaynum = i+1;
         
+        if(DISPLAY_DATA[i].STREAM_BUFFER != NULL) {
+            if (prepareDisplayStream(displaynum, frames[i], &positions[i])) {
+                pending |= (1 << i);
+            }
+            continue;
+        }
+        
         if(stringLengthChanged(displaynum)) {
             setDisplayStringAsNew(DISPLAY_DATA[i].TEXT , displaynum);
         }
         
-        if( (DISPLAY_DATA[i].TEXT_LENGTH <=8) && (!DISPLAY_DATA[i].TEXT_CHANGED) ) {
-            //NOTE:  The following lines are "optional", as they may add
-            //unnecessary extra traffic. However, by leaving the following 
+        if (DISPLAY_DATA[i].TEXT_LENGTH <=8) {
+            //NOTE:  Rewriting unchanged short strings is "optional", as it may add
+            //unnecessary extra traffic. However, by leaving it 
             //active, the display can 'auto-update' short strings without intervention
             DISPLAY_DATA[i].SCROLL_COMPLETE = false;
-            writeDisplay(DISPLAY_DATA[i].TEXT, displaynum);
-         }    
-         else if( (DISPLAY_DATA[i].TEXT_LENGTH <=8) && (DISPLAY_DATA[i].TEXT_CHANGED) ) {
-            //refresh it 
-            DISPLAY_DATA[i].SCROLL_COMPLETE = false;
-            writeDisplay(DISPLAY_DATA[i].TEXT, displaynum);
+            bool blank = false;
+            for (uint8_t displaypos = 0; displaypos < 8; displaypos++) {
+                if ( !blank && DISPLAY_DATA[i].TEXT[displaypos] == 0 ) {
+                    blank = true;
+                }
+                frames[i][displaypos] = blank ? ' ' : DISPLAY_DATA[i].TEXT[displaypos];
+            }
+            positions[i] = 0xFF;
+            pending |= (1 << i);
          }           
-         else if  (DISPLAY_DATA[i].TEXT_LENGTH > 8)  {
-            updateDisplayScroll(displaynum);
+         else if (prepareDisplayScroll(displaynum, frames[i], &positions[i])) {
+            pending |= (1 << i);
          }
          DISPLAY_DATA[i].TEXT_CHANGED = false;
     }
+    
+    for(uint8_t i=0; i < NUMBER_OF_DISPLAYS; i++) {
+        if ( !(pending & (1 << i)) ) {
+            continue;
+        }
+        uint8_t group = 0;
+        uint8_t grouppositions = 0;
+        for(uint8_t j=i; j < NUMBER_OF_DISPLAYS; j++) {
+            if ( (pending & (1 << j)) && (memcmp(frames[i], frames[j], 8) == 0) ) {
+                group |= (1 << j);
+                grouppositions |= positions[j];    //same frame, so extra positions are harmless
+            }
+        }
+        pending &= ~group;
+        writeCharacters(frames[i], grouppositions, group);
+        for(uint8_t j=i; j < NUMBER_OF_DISPLAYS; j++) {
+            if (group & (1 << j)) {
+                MESSAGE_QUEUE[j].PASS_SHOWN = true;
+            }
+        }
+    }
 }
 
 
@@ -431,33 +721,69 @@ void mizraith_HDSP2111::updateDisplays() {
  * must = 1 or 2 right now.
  */
 void mizraith_HDSP2111::writeDisplay(char *input, uint8_t displaynum) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
+        Serial.println(F("!!!! ERROR UNDEFINED DISPLAY ADDRESS (writeDisplay) !!!!!"));
+        return;
+    }
+    writeDisplays(input, HDSP_DISPLAY_MASK(displaynum));
+}
+
+/**
+ * Same as writeDisplay, but every display in displaymask
+ * (bit0 = display 1) gets the string from one set of strobes.
+ */
+void mizraith_HDSP2111::writeDisplays(char *input, uint8_t displaymask) {
+    for(uint8_t i=0; i < NUMBER_OF_DISPLAYS; i++) {
+        if (displaymask & (1 << i)) {
+            DISPLAY_DATA[i].CACHE_SYNCED = false;   //cache resumes at position 0
+        }
+    }
+    writeCharacters(input, 0xFF, displaymask);
+}
+
+/**
+ * Writes only the character positions flagged in the 
+ * positions bitmask (bit0 = leftmost character) to every
+ * display in displaymask, and remembers what was written
+ * in their FRAMEs.
+ */
+void mizraith_HDSP2111::writeCharacters(char *input, uint8_t positions, uint8_t displaymask) {
     uint8_t portA = 0;
-    uint8_t portB = 0;
-  
-    uint8_t dispCE = getDisplayCEFromDisplayNum(displaynum);
 
    for(int i=0; i<8; i++) {
+       if ( !(positions & (1 << i)) ) {
+           continue;
+       }
        portA &= 0xF0;      //clear A0:2 bits before rebuilding
        portA |= 0xF8;      //set A3, RD, WR, CE1, CE2 to high
       
        portA |= i;         //set A0, A1, A2 bits
       
-       portB = input[i];   //Cool!  the HDSP2111 uses ASCII mapping.
+       //Cool!  the HDSP2111 uses ASCII mapping.
+       strobeWrite(portA, input[i], displaymask);
+    }
+    
+    for(uint8_t d=0; d < NUMBER_OF_DISPLAYS; d++) {
+        if ( !(displaymask & (1 << d)) ) {
+            continue;
+        }
+        for(uint8_t i=0; i<8; i++) {
+            if (positions & (1 << i)) {
+                DISPLAY_DATA[d].FRAME[i] = input[i];
+            }
+        }
+    }
+}
 
-       //Put these out on the ports, then toggle write pins
-       mcp_display.writeGPIOA(portA);
-       mcp_display.writeGPIOB(portB);
-       delay(1);
-       //now toggle
-       mcp_display.writePin(dispCE, LOW);
-       delay(1);
-       mcp_display.writePin(HDSP_WR, LOW);
-       delay(1);
-       mcp_display.writePin(dispCE, HIGH);
-       delay(1);
-       mcp_display.writePin(HDSP_WR, HIGH);
-       delay(1);
+uint8_t mizraith_HDSP2111::getCEBitsFromDisplayMask(uint8_t displaymask) {
+    uint8_t ce = 0;
+    if (displaymask & HDSP_DISPLAY_MASK(1)) {
+        ce |= (1 << HDSP_CE1);
+    }
+    if (displaymask & HDSP_DISPLAY_MASK(2)) {
+        ce |= (1 << HDSP_CE2);
     }
+    return ce;
 }
 
 uint8_t mizraith_HDSP2111::getDisplayCEFromDisplayNum(uint8_t displaynum) {
@@ -474,6 +800,108 @@ uint8_t mizraith_HDSP2111::getDisplayCEFromDisplayNum(uint8_t displaynum) {
 }
 
 
+//Swap out the time base used for scrolling and message dwell. 
+void mizraith_HDSP2111::setClockSource(HDSP2111ClockSource clock) {
+    if (clock == NULL) {
+        CLOCK_SOURCE = millis;
+    } else {
+        CLOCK_SOURCE = clock;
+    }
+}
+
+//Swap out the strobe timing used on the HDSP2111 bus.
+void mizraith_HDSP2111::setTimingProfile(const hdsp2111_timing_profile *profile) {
+    if (profile == NULL) {
+        TIMING = &HDSP_TIMING_MCP23017;
+    } else {
+        TIMING = profile;
+    }
+}
+
+//Hold off until requiredns has passed since the last pin change.  The
+//next pin change itself takes BUS_STEP_NS, so only the rest is waited
+//out, rounded up to whole microseconds.
+void mizraith_HDSP2111::strobeWait(uint16_t requiredns) {
+    if (requiredns <= TIMING->BUS_STEP_NS) {
+        return;
+    }
+    delayMicroseconds( ((unsigned long) requiredns - TIMING->BUS_STEP_NS + 999) / 1000 );
+}
+
+unsigned long mizraith_HDSP2111::now(void) {
+    return CLOCK_SOURCE();
+}
+
+//ms left until interval has passed since start, 0 if already there.
+//Unsigned math keeps this correct across a clock rollover.
+unsigned long mizraith_HDSP2111::timeUntil(unsigned long start, unsigned long interval) {
+    unsigned long elapsed = now() - start;
+    if (elapsed >= interval) {
+        return 0;
+    }
+    return interval - elapsed;
+}
+
+
+//Soonest deadline across all displays
+unsigned long mizraith_HDSP2111::getTimeUntilNextUpdate(void) {
+    unsigned long soonest = HDSP_NO_DEADLINE;
+    for(uint8_t i=1; i <= NUMBER_OF_DISPLAYS; i++) {
+        unsigned long t = getTimeUntilNextUpdate(i);
+        if (t < soonest) {
+            soonest = t;
+        }
+    }
+    return soonest;
+}
+
+// Mirrors what GoDogGo would do for the display:
+//    (a) new or changed text is due right away
+//    (b) a queued message finishing its pass is due when its dwell is up,
+//        unless it is static and just sitting there until more is queued
+//    (c) a scrolling string is due SCROLL_DELAY after the last step, which
+//        also covers the restart after an automatic scroll reset
+//    (d) an unchanged static string needs nothing
+unsigned long mizraith_HDSP2111::getTimeUntilNextUpdate(uint8_t displaynum) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
+        return HDSP_NO_DEADLINE;
+    }
+    uint8_t displayindex = displaynum - 1;
+    display_data *data = &DISPLAY_DATA[displayindex];
+    message_queue *queue = &MESSAGE_QUEUE[displayindex];
+    
+    if (data->STREAM_BUFFER != NULL) {
+        if (streamHasWork(displaynum)) {
+            return timeUntil(data->LAST_UPDATE, data->SCROLL_DELAY);
+        }
+        return HDSP_NO_DEADLINE;      //wakes back up on the next streamWrite
+    }
+    if (data->TEXT_CHANGED || stringLengthChanged(displaynum)) {
+        return 0;
+    }
+    
+    unsigned long soonest = HDSP_NO_DEADLINE;
+    bool scrolling = (data->TEXT_LENGTH > 8);
+    
+    if (queue->ACTIVE && (!scrolling || data->SCROLL_COMPLETE)) {
+        if (!queue->PASS_SHOWN) {
+            soonest = 0;                  //not on the chip yet
+        } else if (!scrolling && (queue->CURRENT.REPEAT_COUNT == 0) && (queue->COUNT == 0)) {
+            //static and repeating until something else is queued: idle
+        } else {
+            soonest = timeUntil(queue->PASS_START, getMessageDwell(displaynum));
+        }
+    }
+    if (scrolling && !(queue->ACTIVE && data->SCROLL_COMPLETE)) {
+        unsigned long t = timeUntil(data->LAST_UPDATE, data->SCROLL_DELAY);
+        if (t < soonest) {
+            soonest = t;
+        }
+    }
+    return soonest;
+}
+
+
 uint8_t mizraith_HDSP2111::getBitsFromPercent(uint8_t percent) {
     //calculate 3 bit value from percent, brute-force style
     // 000 = 100%   001 = 80%  010 = 53%  011 = 40%  100 = 27%  101 = 20%  110 = 13%   111 = 0%  
@@ -518,36 +946,56 @@ uint8_t mizraith_HDSP2111::getBitsFromPercent(uint8_t percent) {
  *   boolean  DISPLAYx_SCROLL_COMPLETE  (sets to 1 at end of string and stops operation)
  */
 void mizraith_HDSP2111::updateDisplayScroll(uint8_t displaynum) {
+  char buffer[8];
+  uint8_t positions;
+  
+  if (prepareDisplayScroll(displaynum, buffer, &positions)) {
+    writeCharacters(buffer, positions, HDSP_DISPLAY_MASK(displaynum));
+    MESSAGE_QUEUE[displaynum-1].PASS_SHOWN = true;
+  }
+}
+
+/**
+ * Does the work of updateDisplayScroll, but leaves the next 8 chars
+ * in buffer (and which of them need writing in positions) for the
+ * caller to write out.  Returns false if nothing is due yet.
+ */
+bool mizraith_HDSP2111::prepareDisplayScroll(uint8_t displaynum, char *buffer, uint8_t *positions) {
   char *text;
-  char buffer[9];
   unsigned long temp;
   boolean proceed = true;
   uint8_t scrollindex;
   uint8_t displayindex = displaynum - 1 ;
   
-  if( displaynum > NUMBER_OF_DISPLAYS) {
-    return;
+  if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
+    return false;
   }
   if (DISPLAY_DATA[displayindex].SCROLL_COMPLETE) {
-    return;
+    return false;
   }
 
   //setup display specific values
   scrollindex = DISPLAY_DATA[displayindex].SCROLL_POSITION;
   text = DISPLAY_DATA[displayindex].TEXT;
-  temp = millis() - DISPLAY_DATA[displayindex].LAST_UPDATE;
+  temp = now() - DISPLAY_DATA[displayindex].LAST_UPDATE;
   if (temp < DISPLAY_DATA[displayindex].SCROLL_DELAY) {
       proceed = false;
   } else {
       proceed = true;
-      DISPLAY_DATA[displayindex].LAST_UPDATE = millis();
+      DISPLAY_DATA[displayindex].LAST_UPDATE = now();
   }
 
    //check that it has been long enough since last update 
   if( !proceed ) {
-    return;  
+    return false;  
   } 
   
+  if (playScrollCache(displaynum, buffer, positions)) {
+    return true;
+  }
+  DISPLAY_DATA[displayindex].CACHE_SYNCED = false;     //cache resumes at position 0
+  *positions = 0xFF;
+  
   
   //check if our start index just hit the end of the string
   if(text[scrollindex] != 0) {     
@@ -570,10 +1018,6 @@ void mizraith_HDSP2111::updateDisplayScroll(uint8_t displaynum) {
           }
       }
       
-      buffer[8]=0;
-      writeDisplay(buffer, displaynum);   //where '1' is the display number
-      
-      
       DISPLAY_DATA[displayindex].SCROLL_POSITION++;      
    
    } else {
@@ -582,21 +1026,308 @@ void mizraith_HDSP2111::updateDisplayScroll(uint8_t displaynum) {
        for(int j = 0; j<8; j++) {
          buffer[j] = ' ';
        }
-       buffer[8]=0;
-       writeDisplay(buffer, displaynum);
        
        //start index was at end of string, raise flag
        DISPLAY_DATA[displayindex].SCROLL_COMPLETE = true;
    }
      
-   return;
+   return true;
+
+}
 
+
+
+//Slot msg into the sorted queue.  Normally it goes behind messages of
+//the same priority (FIFO), with ahead=true it goes in front of them.
+//Caller must make sure there is room.
+bool mizraith_HDSP2111::insertQueuedMessage(queued_message msg, uint8_t displaynum, bool ahead) {
+    message_queue *queue = &MESSAGE_QUEUE[displaynum-1];
+    if (queue->COUNT >= MESSAGE_QUEUE_SIZE) {
+        return false;
+    }
+    
+    uint8_t slot = 0;
+    while (slot < queue->COUNT) {
+        uint8_t p = queue->MESSAGES[slot].PRIORITY;
+        if ( (p < msg.PRIORITY) || (ahead && p == msg.PRIORITY) ) {
+            break;
+        }
+        slot++;
+    }
+    for (uint8_t j = queue->COUNT; j > slot; j--) {
+        queue->MESSAGES[j] = queue->MESSAGES[j-1];
+    }
+    queue->MESSAGES[slot] = msg;
+    queue->COUNT++;
+    return true;
+}
+
+
+//Pop the head of the queue onto the display
+void mizraith_HDSP2111::startQueuedMessage(uint8_t displaynum) {
+    message_queue *queue = &MESSAGE_QUEUE[displaynum-1];
+    if (queue->COUNT == 0) {
+        return;
+    }
+    queue->CURRENT = queue->MESSAGES[0];
+    queue->COUNT--;
+    for (uint8_t j = 0; j < queue->COUNT; j++) {
+        queue->MESSAGES[j] = queue->MESSAGES[j+1];
+    }
+    startMessagePass(displaynum);
+}
+
+
+void mizraith_HDSP2111::startMessagePass(uint8_t displaynum) {
+    message_queue *queue = &MESSAGE_QUEUE[displaynum-1];
+    queue->ACTIVE = true;
+    queue->PASS_SHOWN = false;
+    queue->PASS_START = now();
+    setDisplayStringAsNew(queue->CURRENT.TEXT, displaynum);
+}
+
+
+// A pass is done once it has been written to the chip, a scrolling message 
+// has scrolled off (SCROLL_COMPLETE) and, for any message, the dwell has
+// gone by since the pass started.  Then we either repeat, or retire the
+// message, fire the callback and move on to the next one.  When the queue
+// runs dry the display is blanked.
+void mizraith_HDSP2111::updateMessageQueue(uint8_t displaynum) {
+    uint8_t displayindex = displaynum - 1;
+    message_queue *queue = &MESSAGE_QUEUE[displayindex];
+    
+    if ( !queue->ACTIVE || (DISPLAY_DATA[displayindex].STREAM_BUFFER != NULL) ) {
+        return;
+    }
+    if (!queue->PASS_SHOWN) {
+        return;
+    }
+    bool scrolling = (DISPLAY_DATA[displayindex].TEXT_LENGTH > 8);
+    if ( scrolling && !DISPLAY_DATA[displayindex].SCROLL_COMPLETE ) {
+        return;
+    }
+    if ( (now() - queue->PASS_START) < getMessageDwell(displaynum) ) {
+        return;
+    }
+    
+    bool repeat = false;
+    if (queue->CURRENT.REPEAT_COUNT == 0) {
+        if (queue->COUNT > 0) {
+            repeat = false;                //someone else wants the display
+        } else if (scrolling) {
+            repeat = true;
+        } else {
+            return;                        //static, just leave it up
+        }
+    } else if (queue->CURRENT.REPEAT_COUNT > 1) {
+        queue->CURRENT.REPEAT_COUNT--;
+        repeat = true;
+    }
+    
+    if (repeat) {
+        setScrollCompleteFlag(false, displaynum);
+        setScrollPosition(0, displaynum);
+        queue->PASS_SHOWN = false;
+        queue->PASS_START = now();
+        return;
+    }
+    
+    queue->ACTIVE = false;
+    if (MESSAGE_CALLBACK != NULL) {
+        MESSAGE_CALLBACK(displaynum, queue->CURRENT.TEXT);
+    }
+    if (queue->ACTIVE) {
+        return;           //callback queued something and it has already started
+    }
+    if (queue->COUNT > 0) {
+        startQueuedMessage(displaynum);
+    } else {
+        setDisplayStringAsNew(BLANK_STRING, displaynum);
+    }
+}
+
+
+
+//How long the current pass has to stay up.  A short static message with
+//no dwell of its own gets one SCROLL_DELAY, so it is actually readable.
+unsigned long mizraith_HDSP2111::getMessageDwell(uint8_t displaynum) {
+    uint8_t displayindex = displaynum - 1;
+    uint16_t dwell = MESSAGE_QUEUE[displayindex].CURRENT.DWELL_TIME;
+    if ( (dwell == 0) && (DISPLAY_DATA[displayindex].TEXT_LENGTH <= 8) ) {
+        dwell = DISPLAY_DATA[displayindex].SCROLL_DELAY;
+    }
+    return dwell;
+}
+
+
+
+/**
+ * Pre-computes the whole scroll sequence for the display's string
+ * into its CACHE, one entry per step:
+ *     [change mask] [new char for each set bit, leftmost first]
+ * The first step is a full frame (mask 0xFF), the rest only carry
+ * characters that differ from the step before.  There are
+ * TEXT_LENGTH+1 steps, the last being the blank frame that pushes
+ * the final character off.  A copy of the string follows the steps,
+ * so edits made in place can be spotted.  If it doesn't fit,
+ * CACHE_LENGTH is left at 0 and updateDisplayScroll works it out
+ * live as before.
+ */
+void mizraith_HDSP2111::buildScrollCache(uint8_t displaynum) {
+    uint8_t displayindex = displaynum - 1;
+    display_data *data = &DISPLAY_DATA[displayindex];
+    
+    data->CACHE_LENGTH = 0;
+    data->CACHE_OFFSET = 0;
+    data->CACHE_SYNCED = false;
+    
+    uint8_t length = strlen(data->TEXT);
+    if ( (data->CACHE == NULL) || (length <= 8) ) {
+        return;
+    }
+    
+    char previous[8];
+    uint16_t used = 0;
+    for (uint16_t step = 0; step <= length; step++) {
+        uint8_t mask = 0;
+        uint16_t maskat = used++;
+        if (maskat >= data->CACHE_SIZE) {
+            return;
+        }
+        for (uint8_t displaypos = 0; displaypos < 8; displaypos++) {
+            uint16_t textpos = step + displaypos;
+            char c = (textpos < length) ? data->TEXT[textpos] : ' ';
+            if ( (step == 0) || (c != previous[displaypos]) ) {
+                if (used >= data->CACHE_SIZE) {
+                    return;
+                }
+                data->CACHE[used++] = c;
+                mask |= (1 << displaypos);
+            }
+            previous[displaypos] = c;
+        }
+        data->CACHE[maskat] = mask;
+    }
+    if (used + length > data->CACHE_SIZE) {
+        return;
+    }
+    memcpy(&data->CACHE[used], data->TEXT, length);
+    data->CACHE_TEXT_LENGTH = length;
+    data->CACHE_LENGTH = used;
+}
+
+
+//Compares TEXT against the copy taken when the cache was built.  Run
+//once per scroll pass, so strings edited in place don't leave a stale
+//cache behind.
+bool mizraith_HDSP2111::cachedTextMatches(uint8_t displaynum) {
+    display_data *data = &DISPLAY_DATA[displaynum-1];
+    uint8_t length = data->CACHE_TEXT_LENGTH;
+    return ( (memcmp(data->TEXT, &data->CACHE[data->CACHE_LENGTH], length) == 0) &&
+             (data->TEXT[length] == '\0') );
+}
+
+
+/**
+ * Plays the next cached scroll step, if the cache is valid and the
+ * chip is known to show the step before it (or we are starting over
+ * at position 0).  Returns false to fall back to the live path.
+ */
+bool mizraith_HDSP2111::playScrollCache(uint8_t displaynum, char *buffer, uint8_t *positions) {
+    uint8_t displayindex = displaynum - 1;
+    display_data *data = &DISPLAY_DATA[displayindex];
+    
+    if (data->CACHE_LENGTH == 0) {
+        return false;
+    }
+    if (data->SCROLL_POSITION == 0) {
+        if ( !cachedTextMatches(displaynum) ) {
+            buildScrollCache(displaynum);         //edited in place
+            if (data->CACHE_LENGTH == 0) {
+                return false;
+            }
+        }
+        data->CACHE_OFFSET = 0;
+        data->CACHE_SYNCED = true;
+    }
+    if ( !data->CACHE_SYNCED || (data->CACHE_OFFSET >= data->CACHE_LENGTH) ) {
+        return false;
+    }
+    
+    uint8_t mask = data->CACHE[data->CACHE_OFFSET++];
+    for (uint8_t displaypos = 0; displaypos < 8; displaypos++) {
+        if (mask & (1 << displaypos)) {
+            buffer[displaypos] = data->CACHE[data->CACHE_OFFSET++];
+        } else {
+            buffer[displaypos] = data->FRAME[displaypos];
+        }
+    }
+    *positions = mask;
+    
+    if (data->SCROLL_POSITION >= data->TEXT_LENGTH) {
+        data->SCROLL_COMPLETE = true;          //that was the blank frame
+    } else {
+        data->SCROLL_POSITION++;
+    }
+    return true;
+}
+
+
+
+//true if the next stream step would change the display
+bool mizraith_HDSP2111::streamHasWork(uint8_t displaynum) {
+    display_data *data = &DISPLAY_DATA[displaynum-1];
+    if (data->STREAM_COUNT > 0) {
+        return true;
+    }
+    return ( (data->STREAM_IDLE == HDSP_STREAM_IDLE_BLANK) && (data->STREAM_PADDING < 8) );
+}
+
+
+/**
+ * Streaming counterpart to updateDisplayScroll.  Every SCROLL_DELAY
+ * the 8 chars on the display (FRAME) shift left by one and the next
+ * char from the ring buffer comes in on the right.  Once the ring is
+ * empty we either hold, or scroll blanks in until the display is clear,
+ * depending on STREAM_IDLE.  Only the changed positions are flagged
+ * in positions.  Returns false if nothing is due yet.
+ */
+bool mizraith_HDSP2111::prepareDisplayStream(uint8_t displaynum, char *buffer, uint8_t *positions) {
+    uint8_t displayindex = displaynum - 1;
+    display_data *data = &DISPLAY_DATA[displayindex];
+    
+    if (timeUntil(data->LAST_UPDATE, data->SCROLL_DELAY) > 0) {
+        return false;
+    }
+    if (!streamHasWork(displaynum)) {
+        return false;
+    }
+    data->LAST_UPDATE = now();
+    
+    char next = ' ';
+    if (data->STREAM_COUNT > 0) {
+        next = data->STREAM_BUFFER[data->STREAM_HEAD];
+        data->STREAM_HEAD = (data->STREAM_HEAD + 1) % data->STREAM_SIZE;
+        data->STREAM_COUNT--;
+        data->STREAM_PADDING = 0;
+    } else {
+        data->STREAM_PADDING++;
+    }
+    
+    *positions = 0;
+    for (uint8_t displaypos = 0; displaypos < 8; displaypos++) {
+        buffer[displaypos] = (displaypos < 7) ? data->FRAME[displaypos+1] : next;
+        if (buffer[displaypos] != data->FRAME[displaypos]) {
+            *positions |= (1 << displaypos);
+        }
+    }
+    return true;
 }
 
 
 
 bool mizraith_HDSP2111::stringLengthChanged( uint8_t displaynum ) {
-    if( displaynum > NUMBER_OF_DISPLAYS) {
+    if( (displaynum == 0) || (displaynum > NUMBER_OF_DISPLAYS) ) {
         return false;
     } else {
         uint8_t displayindex = displaynum - 1;
@@ -617,7 +1348,7 @@ bool mizraith_HDSP2111::stringLengthChanged( uint8_t displaynum ) {
 void mizraith_HDSP2111::DEBUG_PrintDisplayData( void ) {
     Serial.println(F("___HDSP2111_DISPLAY_DATA___"));
     for(uint8_t i=0; i < NUMBER_OF_DISPLAYS; i++) {
-        uint16_t p = (uint16_t) &(DISPLAY_DATA[i]);
+        uint16_t p = (uint16_t) (uintptr_t) &(DISPLAY_DATA[i]);
         Serial.print(F("___ADDR: "));
         Serial.print(p, DEC);
         Serial.print(F("  --->"));
@@ -634,6 +1365,12 @@ void mizraith_HDSP2111::DEBUG_PrintDisplayData( void ) {
         Serial.println(DISPLAY_DATA[i].SCROLL_COMPLETE );
         Serial.print(F("_TextChanged   : "));
         Serial.println(DISPLAY_DATA[i].TEXT_CHANGED);
+        Serial.print(F("_StreamCount   : "));
+        Serial.println(DISPLAY_DATA[i].STREAM_COUNT);
+        Serial.print(F("_QueueActive   : "));
+        Serial.println(MESSAGE_QUEUE[i].ACTIVE);
+        Serial.print(F("_QueueCount    : "));
+        Serial.println(MESSAGE_QUEUE[i].COUNT);
     }
 }
 
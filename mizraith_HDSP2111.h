@@ -22,6 +22,40 @@
 #endif
 
 
+//Called once a queued message has finished all of its repeats.
+typedef void (*HDSP2111MessageCallback)(uint8_t displaynum, char *text);
+//Time source in ms.  Defaults to millis(), swap in a virtual clock for testing.
+typedef unsigned long (*HDSP2111ClockSource)(void);
+
+//returned by getTimeUntilNextUpdate when nothing is scheduled
+#define HDSP_NO_DEADLINE  0xFFFFFFFFUL
+
+//display masks for the broadcast methods, bit0 = display 1
+//out-of-range display numbers (including 0) map to an empty mask
+#define HDSP_DISPLAY_MASK(displaynum)  ( ((displaynum) >= 1 && (displaynum) <= 8) ? (1 << ((displaynum)-1)) : 0 )
+#define HDSP_ALL_DISPLAYS              0x03
+
+//what a streaming display does when its ring buffer runs dry
+#define HDSP_STREAM_IDLE_HOLD    0    //stop, leave the last 8 chars up
+#define HDSP_STREAM_IDLE_BLANK   1    //keep scrolling blanks in until clear
+
+/* Strobe timing: HDSP2111 datasheet minimums (ns) plus how long the
+   transport already takes between two pin changes.  Waits are only
+   added where a minimum is longer than BUS_STEP_NS.  */
+struct hdsp2111_timing_profile {
+    uint16_t ADDRESS_SETUP_NS;   //tAS/tDS  address+data stable before WR rises
+    uint16_t WRITE_PULSE_NS;     //tW       WR low
+    uint16_t HOLD_NS;            //tAH/tDH  after WR/CE/RD release
+    uint16_t READ_ACCESS_NS;     //tACC     RD low to data valid
+    uint16_t BUS_STEP_NS;        //transport time per pin change (saturates)
+};
+
+//MCP23017 over I2C -- each pin change is a whole I2C transaction,
+//so every datasheet minimum is already met.  The default.
+extern const hdsp2111_timing_profile HDSP_TIMING_MCP23017;
+//Full datasheet waits, for a transport that can toggle pins quickly
+extern const hdsp2111_timing_profile HDSP_TIMING_DATASHEET;
+
         
 class mizraith_HDSP2111 {
     Adafruit_MCP23017 mcp_display;
@@ -40,8 +74,45 @@ class mizraith_HDSP2111 {
 	    uint16_t      SCROLL_DELAY;
 	    bool          SCROLL_COMPLETE;  //  (sets to 1 at end of string and stops operation)
 	    bool   	      TEXT_CHANGED;
+	    char          FRAME[8];         //what we last wrote to the chip
+	    uint8_t      *CACHE;            //optional delta-encoded scroll frames
+	    uint16_t      CACHE_SIZE;
+	    uint16_t      CACHE_LENGTH;     //bytes used, 0 = no valid cache
+	    uint16_t      CACHE_OFFSET;     //next step to play back
+	    bool          CACHE_SYNCED;     //chip shows the frame before CACHE_OFFSET
+	    uint8_t       CACHE_TEXT_LENGTH; //copy of TEXT kept after the steps
+	    char         *STREAM_BUFFER;    //ring buffer, NULL = normal TEXT mode
+	    uint8_t       STREAM_SIZE;
+	    uint8_t       STREAM_HEAD;      //next char to scroll in
+	    uint8_t       STREAM_COUNT;     //chars waiting
+	    uint8_t       STREAM_IDLE;      //HDSP_STREAM_IDLE_xxx
+	    uint8_t       STREAM_PADDING;   //blanks scrolled in since running dry
     } DISPLAY_DATA[NUMBER_OF_DISPLAYS];
 
+    const static uint8_t MESSAGE_QUEUE_SIZE = 4;
+
+    /* A message waiting its turn on a display */
+    struct queued_message {
+        char         *TEXT;
+        uint8_t       PRIORITY;         //higher value preempts lower
+        uint8_t       REPEAT_COUNT;     //passes left, 0 = until another message waits
+        uint16_t      DWELL_TIME;       //minimum ms each pass stays up
+    };
+
+    /* Fixed size queue, kept sorted highest priority first */
+    struct message_queue {
+        queued_message MESSAGES[MESSAGE_QUEUE_SIZE];
+        uint8_t        COUNT;
+        queued_message CURRENT;
+        bool           ACTIVE;          //CURRENT is being shown
+        bool           PASS_SHOWN;      //this pass has made it to the chip
+        unsigned long  PASS_START;
+    } MESSAGE_QUEUE[NUMBER_OF_DISPLAYS];
+
+    HDSP2111MessageCallback MESSAGE_CALLBACK;
+    HDSP2111ClockSource     CLOCK_SOURCE;
+    const hdsp2111_timing_profile *TIMING;
+
 	
   public:
       mizraith_HDSP2111(void);
@@ -52,6 +123,7 @@ class mizraith_HDSP2111 {
 	  //where brightness value is 0:6 inclusive.  We don't allow an 'off' setting of 7
 	  void setBrightnessForAllDisplays(uint8_t value);
 	  void setBrightnessForDisplay(uint8_t value, uint8_t displaynum);
+	  void setBrightnessForDisplays(uint8_t value, uint8_t displaymask);
 	  //where percentage is 0-100%
 	  void setBrightnessPercentageForAllDisplays(uint8_t percent);
 	  void setBrightnessPercentageForDisplay(uint8_t percent, uint8_t displaynum);
@@ -81,11 +153,67 @@ class mizraith_HDSP2111 {
 	  void setDisplayStringAsNew(char *words, uint8_t displaynum);
 	  
 	  char * getDisplayString(uint8_t displaynum);
+	  
+	  //SCROLL CACHE -- optional, hand it a buffer (NULL turns it off) and
+	  //each new scrolling string is pre-encoded once as per-step deltas.
+	  //Steps then only write the characters that change.  Needs about
+	  //(length+1)*(1+changed chars) + length bytes; strings that don't fit
+	  //scroll the normal way.  Strings edited in place are picked up (and
+	  //re-encoded) each time the scroll starts over.
+	  void setScrollCache(uint8_t *buffer, uint16_t size, uint8_t displaynum);
+	  bool isScrollCacheValid(uint8_t displaynum);
+	  
+	  
+	  //STREAMING -- scroll an endless stream (e.g. from Serial) through a
+	  //small ring buffer supplied by the caller, instead of TEXT.  Chars
+	  //are consumed one per scroll step.  streamWrite returns how many
+	  //chars fit, the rest should be retried later (backpressure).
+	  //Not interrupt safe, push from loop().  Queued messages wait while
+	  //streaming, endStream goes back to the display string.
+	  void beginStream(char *buffer, uint8_t size, uint8_t displaynum, uint8_t idlemode = HDSP_STREAM_IDLE_HOLD);
+	  void endStream(uint8_t displaynum);
+	  bool isStreaming(uint8_t displaynum);
+	  bool streamWrite(char c, uint8_t displaynum);
+	  uint8_t streamWrite(const char *data, uint8_t length, uint8_t displaynum);
+	  uint8_t getStreamSpace(uint8_t displaynum);
+	  
+	  
+	  //MESSAGE QUEUE -- MESSAGE_QUEUE_SIZE deep per display, no heap.
+	  //  priority: a higher priority message interrupts the one showing,
+	  //            which resumes once the queue gets back to it
+	  //  repeats:  number of passes, 0 = keep repeating until another message waits
+	  //  dwellms:  minimum time each pass stays up, 0 = one scroll delay for
+	  //            short static strings, until scrolled off for long ones
+	  //A full queue drops its lowest waiting message for one that outranks
+	  //it, otherwise returns false.
+	  bool queueMessage(char *words, uint8_t displaynum, uint8_t priority = 0, uint8_t repeats = 1, uint16_t dwellms = 0);
+	  void clearMessageQueue(uint8_t displaynum);
+	  uint8_t getMessageQueueCount(uint8_t displaynum);
+	  bool isMessageQueueActive(uint8_t displaynum);
+	  void setMessageCompleteCallback(HDSP2111MessageCallback callback);
+	  //advances the queues, called for you by GoDogGo
+	  void updateMessageQueues(void);
 	    
   
+	  //TICKLESS OPERATION
+	  //ms until GoDogGo next has work to do (scroll step, queue dwell, changed
+	  //text), 0 if it is due now, HDSP_NO_DEADLINE if nothing is scheduled.
+	  //Sleep or do other work until then instead of spinning on GoDogGo.
+	  //NOTE: static strings edited in place are only noticed when GoDogGo
+	  //runs, so use setDisplayString to flag them.
+	  unsigned long getTimeUntilNextUpdate(void);
+	  unsigned long getTimeUntilNextUpdate(uint8_t displaynum);
+	  //NULL restores millis()
+	  void setClockSource(HDSP2111ClockSource clock);
+	  
+	  
+	  //NULL restores HDSP_TIMING_MCP23017
+	  void setTimingProfile(const hdsp2111_timing_profile *profile);
+	  
+	  
 	  //PRIMARY CONVENIENCE ALL-IN-ONE METHOD TO BE CALLED EVERY LOOP
-	  // wraps up the automatic scroll flag reset with the 
-	  //update displays method.
+	  // wraps up the message queues and automatic scroll flag reset
+	  //with the update displays method.
 	  void GoDogGo(void);       
 	  
 	  
@@ -101,6 +229,8 @@ class mizraith_HDSP2111 {
 	  
 	 //these could be private
 	  void writeDisplay(char *input, uint8_t displaynum); 
+	  //BROADCAST -- one set of strobes for every display in the mask
+	  void writeDisplays(char *input, uint8_t displaymask);
 	  void updateDisplayScroll(uint8_t displaynum);
 	  
 	  void DEBUG_PrintDisplayData( void );
@@ -111,8 +241,27 @@ class mizraith_HDSP2111 {
       bool stringLengthChanged( uint8_t displaynum );
       uint8_t getDisplayControlRegister(uint8_t displaynum);
       uint8_t getDisplayCEFromDisplayNum(uint8_t displaynum);
+      uint8_t getCEBitsFromDisplayMask(uint8_t displaymask);
+      void resetDisplayData(uint8_t displaynum);
       uint8_t getBitsFromPercent(uint8_t percent);
+      unsigned long now(void);
+      void strobeWait(uint16_t requiredns);
+      unsigned long timeUntil(unsigned long start, unsigned long interval);
       void clearControlWord(uint8_t displaynum);
+      void writeControlWord(uint8_t controlword, uint8_t displaymask);
+      void strobeWrite(uint8_t portA, uint8_t data, uint8_t displaymask);
+      void writeCharacters(char *input, uint8_t positions, uint8_t displaymask);
+      bool prepareDisplayScroll(uint8_t displaynum, char *buffer, uint8_t *positions);
+      void buildScrollCache(uint8_t displaynum);
+      bool playScrollCache(uint8_t displaynum, char *buffer, uint8_t *positions);
+      bool cachedTextMatches(uint8_t displaynum);
+      bool streamHasWork(uint8_t displaynum);
+      bool prepareDisplayStream(uint8_t displaynum, char *buffer, uint8_t *positions);
+      bool insertQueuedMessage(queued_message msg, uint8_t displaynum, bool ahead);
+      void startQueuedMessage(uint8_t displaynum);
+      void startMessagePass(uint8_t displaynum);
+      void updateMessageQueue(uint8_t displaynum);
+      unsigned long getMessageDwell(uint8_t displaynum);
  
 };
 